@@ -4,5 +4,5 @@
 
 USER_OBJS :=
 
-LIBS := -lgdal -lmfhdf -lwcs20-d -luuid
+LIBS := -lgdal -lhdfeos -lGctp -lmfhdf -lwcs20-d -luuid -lpthread
 
@@ -4,5 +4,5 @@
 
 USER_OBJS :=
 
-LIBS := -lgdal -lwcs20-r -luuid
+LIBS := -lgdal -lhdfeos -lGctp -lmfhdf -lwcs20-r -luuid -lpthread
 
@@ -33,26 +33,32 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
+../src/WCS_Cache.cpp \
 ../src/WCS_Configure.cpp \
 ../src/WCS_DescribeCoverage.cpp \
 ../src/WCS_GetCapabilities.cpp \
 ../src/WCS_GetCoverage.cpp \
+../src/WCS_GetStoredCoverage.cpp \
 ../src/WCS_T.cpp \
 ../src/wcst.cpp 
 
 OBJS += \
+./src/WCS_Cache.o \
 ./src/WCS_Configure.o \
 ./src/WCS_DescribeCoverage.o \
 ./src/WCS_GetCapabilities.o \
 ./src/WCS_GetCoverage.o \
+./src/WCS_GetStoredCoverage.o \
 ./src/WCS_T.o \
 ./src/wcst.o 
 
 CPP_DEPS += \
+./src/WCS_Cache.d \
 ./src/WCS_Configure.d \
 ./src/WCS_DescribeCoverage.d \
 ./src/WCS_GetCapabilities.d \
 ./src/WCS_GetCoverage.d \
+./src/WCS_GetStoredCoverage.d \
 ./src/WCS_T.d \
 ./src/wcst.d 
 
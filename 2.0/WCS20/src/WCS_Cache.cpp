@@ -0,0 +1,539 @@
+/******************************************************************************
+ * $Id: WCS_Cache.cpp $
+ *
+ * Project:  The Open Geospatial Consortium (OGC) Web Coverage Service (WCS)
+ * 			 for Earth Observation: Open Source Reference Implementation
+ * Purpose:  WCS_Cache class implementation
+ * Author:   Yuanzheng Shao, yshao3@gmu.edu
+ *
+ ******************************************************************************
+ * Copyright (c) 2011, Liping Di <ldi@gmu.edu>, Yuanzheng Shao <yshao3@gmu.edu>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+
+
+#include "WCS_Cache.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <utime.h>
+
+/* flock() polled with LOCK_NB every 50 ms, up to the timeout in seconds */
+static int FlockWithTimeout(int fd, int nOperation, int nTimeout)
+{
+	time_t tStart = time(NULL);
+	while (flock(fd, nOperation | LOCK_NB) != 0)
+	{
+		if ((errno != EWOULDBLOCK && errno != EINTR) || time(NULL) - tStart >= nTimeout)
+			return FALSE;
+		CPLSleep(0.05);
+	}
+
+	return TRUE;
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                               WCS_Cache                              */
+/* ==================================================================== */
+/************************************************************************/
+
+/**
+ * \class WCS_Cache "WCS_Cache.h"
+ *
+ * This class is used to cache the outputs of GetCoverage request on local
+ * disk, so that identical requests are served without opening, warping and
+ * encoding the coverage again. Each output is named by the hash of the
+ * canonical form of its request, and the canonical request is kept in a
+ * "<hash>.key" file next to it, which is compared on lookup to rule out
+ * hash collisions. The file name of the stored output is kept in a
+ * "<hash>.name" file, so that a hit is delivered under the same name. The modification time of an output is refreshed on each
+ * hit, and the least recently used outputs are removed when the total size
+ * exceeds the budget.
+ *
+ * The identical requests running at the same time are coalesced with an
+ * exclusive flock() on "<hash>.lock": the first request computes and stores
+ * the output while holding the lock, and the others wait for the lock and
+ * are then served by its output. The lock works across the CGI processes
+ * and is released when the process exits. The locks are polled without
+ * blocking up to a timeout, a request giving up computes without the cache.
+ *
+ * The files still in use by a request, e.g. the tiles or blocks read by
+ * gdalwarp, are pinned with a shared flock() on the files themselves, and
+ * Evict() only removes a file while holding its exclusive lock.
+ */
+
+/************************************************************************/
+/*                              WCS_Cache()                             */
+/************************************************************************/
+
+/**
+ * \brief Constructor of a WCS_Cache object.
+ *
+ * @param sCacheDir The directory of the cached outputs, empty to disable the cache.
+ *
+ * @param nMaxSize The size budget of the cache, in bytes.
+ *
+ * @param nLockTimeout The time to wait for a lock or a pin, in seconds.
+ */
+
+WCS_Cache::WCS_Cache(const string& sCacheDir, GIntBig nMaxSize, int nLockTimeout)
+{
+	ms_CacheDir = sCacheDir;
+	mn_MaxSize = nMaxSize;
+	mn_LockTimeout = nLockTimeout;
+	mn_LockFd = -1;
+}
+
+WCS_Cache::~WCS_Cache()
+{
+	Unlock();
+	Unpin();
+}
+
+/************************************************************************/
+/*                              IsEnabled()                             */
+/************************************************************************/
+
+/**
+ * \brief Whether the cache directory is configured and could be written.
+ *
+ * @return TRUE if the cache is enabled, FALSE otherwise.
+ */
+
+int WCS_Cache::IsEnabled()
+{
+	if (ms_CacheDir.empty())
+		return FALSE;
+
+	VSIStatBufL sStat;
+	if (VSIStatL(ms_CacheDir.c_str(), &sStat) != 0)
+		VSIMkdir(ms_CacheDir.c_str(), 0755);
+
+	return access(ms_CacheDir.c_str(), W_OK) == 0;
+}
+
+/************************************************************************/
+/*                                GetKey()                              */
+/************************************************************************/
+
+/**
+ * \brief Fetch the cache key of a canonical request.
+ *
+ * @param sCanonicalRequest The canonical form of the request.
+ *
+ * @return The hash of the canonical request.
+ */
+
+string WCS_Cache::GetKey(const string& sCanonicalRequest)
+{
+	return GetStringHash(sCanonicalRequest);
+}
+
+/************************************************************************/
+/*                           GetEntryFileName()                         */
+/************************************************************************/
+
+string WCS_Cache::GetEntryFileName(const string& sKey, const string& sSuffix)
+{
+	return string(CPLFormFilename(ms_CacheDir.c_str(), sKey.c_str(), NULL)) + sSuffix;
+}
+
+/************************************************************************/
+/*                                Lookup()                              */
+/************************************************************************/
+
+/**
+ * \brief Look up the cached output of a request.
+ *
+ * This method is used to find the cached output of a request. On a hit,
+ * the modification time of the output is refreshed to mark it as recently
+ * used.
+ *
+ * @param sCanonicalRequest The canonical form of the request.
+ *
+ * @param sSuffix The suffix of the output file.
+ *
+ * @param sCachedFileName The full path of the cached output, returned on a hit.
+ *
+ * @param nMaxAge The maximum age (in seconds since last use) of the output,
+ * -1 for no limit.
+ *
+ * @return TRUE on a hit, FALSE otherwise.
+ */
+
+int WCS_Cache::Lookup(const string& sCanonicalRequest, const string& sSuffix, string& sCachedFileName, int nMaxAge)
+{
+	string sKey = GetKey(sCanonicalRequest);
+	string sEntryFileName = GetEntryFileName(sKey, sSuffix);
+
+	ifstream keyFile(GetEntryFileName(sKey, ".key").c_str());
+	if (!keyFile)
+		return FALSE;
+	string sStoredRequest((istreambuf_iterator<char>(keyFile)), istreambuf_iterator<char>());
+	keyFile.close();
+
+	VSIStatBufL sStat;
+	if (sStoredRequest != sCanonicalRequest || VSIStatL(sEntryFileName.c_str(), &sStat) != 0)
+		return FALSE;
+	if (nMaxAge >= 0 && time(NULL) - sStat.st_mtime > nMaxAge)
+		return FALSE;
+
+	utime(sEntryFileName.c_str(), NULL);
+	sCachedFileName = sEntryFileName;
+
+	return TRUE;
+}
+
+/************************************************************************/
+/*                                 Store()                              */
+/************************************************************************/
+
+/**
+ * \brief Store the output of a request into the cache.
+ *
+ * This method is used to add the output of a request to the cache. The
+ * output is linked into the cache directory by LinkFile(), and then
+ * renamed to its entry name, so that the concurrent requests never see a
+ * partial file. The file name of the output is kept with the entry, see
+ * GetStoredName(). The cache is trimmed to its budget afterwards.
+ *
+ * @param sCanonicalRequest The canonical form of the request.
+ *
+ * @param sSuffix The suffix of the output file.
+ *
+ * @param sOutFileName The full path of the output file.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr WCS_Cache::Store(const string& sCanonicalRequest, const string& sSuffix, const string& sOutFileName)
+{
+	string sKey = GetKey(sCanonicalRequest);
+	string sEntryFileName = GetEntryFileName(sKey, sSuffix);
+	string sKeyFileName = GetEntryFileName(sKey, ".key");
+	string sNameFileName = GetEntryFileName(sKey, ".name");
+	int nPid = (int)getpid();
+	string sPid = convertToString(nPid);
+	string sTmpEntryFileName = sEntryFileName + "." + sPid + ".tmp";
+	string sTmpKeyFileName = sKeyFileName + "." + sPid + ".tmp";
+	string sTmpNameFileName = sNameFileName + "." + sPid + ".tmp";
+
+	if (CE_None != LinkFile(sOutFileName, sTmpEntryFileName))
+		return CE_Failure;
+
+	ofstream keyFile(sTmpKeyFileName.c_str());
+	keyFile << sCanonicalRequest;
+	keyFile.close();
+	ofstream nameFile(sTmpNameFileName.c_str());
+	nameFile << CPLGetFilename(sOutFileName.c_str());
+	nameFile.close();
+
+	//The name is in place before the entry, so that a hit always finds it
+	if (!keyFile || !nameFile || rename(sTmpNameFileName.c_str(), sNameFileName.c_str()) != 0 ||
+		rename(sTmpEntryFileName.c_str(), sEntryFileName.c_str()) != 0 ||
+		rename(sTmpKeyFileName.c_str(), sKeyFileName.c_str()) != 0)
+	{
+		unlink(sTmpEntryFileName.c_str());
+		unlink(sTmpKeyFileName.c_str());
+		unlink(sTmpNameFileName.c_str());
+		return CE_Failure;
+	}
+
+	return Evict();
+}
+
+/************************************************************************/
+/*                             GetStoredName()                          */
+/************************************************************************/
+
+/**
+ * \brief Fetch the file name of the output stored for a request.
+ *
+ * @param sCanonicalRequest The canonical form of the request.
+ *
+ * @return The file name (without directory) given to Store(), empty if unknown.
+ */
+
+string WCS_Cache::GetStoredName(const string& sCanonicalRequest)
+{
+	ifstream nameFile(GetEntryFileName(GetKey(sCanonicalRequest), ".name").c_str());
+	if (!nameFile)
+		return "";
+
+	return string((istreambuf_iterator<char>(nameFile)), istreambuf_iterator<char>());
+}
+
+/************************************************************************/
+/*                                 Evict()                              */
+/************************************************************************/
+
+/**
+ * \brief Remove the least recently used outputs beyond the size budget.
+ *
+ * The files pinned by the running requests are kept, even beyond the budget.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr WCS_Cache::Evict()
+{
+	char** papszFiles = VSIReadDir(ms_CacheDir.c_str());
+	if (!papszFiles)
+		return CE_Failure;
+
+	vector<pair<GIntBig, string> > vEntries;	//(modification time, file name)
+	GIntBig nTotalSize = 0;
+	for (int i = 0; papszFiles[i] != NULL; i++)
+	{
+		string sFileName = papszFiles[i];
+		if (sFileName == "." || sFileName == ".." || EQUAL(CPLGetExtension(sFileName.c_str()), "key") ||
+			EQUAL(CPLGetExtension(sFileName.c_str()), "name") ||
+			EQUAL(CPLGetExtension(sFileName.c_str()), "tmp") || EQUAL(CPLGetExtension(sFileName.c_str()), "lock") ||
+			EQUAL(CPLGetExtension(sFileName.c_str()), "stats"))
+			continue;
+
+		VSIStatBufL sStat;
+		string sFullName = CPLFormFilename(ms_CacheDir.c_str(), sFileName.c_str(), NULL);
+		if (VSIStatL(sFullName.c_str(), &sStat) != 0 || !VSI_ISREG(sStat.st_mode))
+			continue;
+
+		nTotalSize += sStat.st_size;
+		vEntries.push_back(make_pair((GIntBig)sStat.st_mtime, sFullName));
+	}
+	CSLDestroy(papszFiles);
+
+	if (nTotalSize <= mn_MaxSize)
+		return CE_None;
+
+	sort(vEntries.begin(), vEntries.end());
+	for (size_t i = 0; i < vEntries.size() && nTotalSize > mn_MaxSize; i++)
+	{
+		//The pinned files are skipped, they are unlinked under the exclusive lock so that
+		//Pin() could tell a removed file from a kept one
+		int fd = open(vEntries[i].second.c_str(), O_RDONLY);
+		if (fd < 0)
+			continue;
+		if (flock(fd, LOCK_EX | LOCK_NB) != 0)
+		{
+			close(fd);
+			continue;
+		}
+		GIntBig nSize = GetFileByteSize(vEntries[i].second);
+		if (unlink(vEntries[i].second.c_str()) == 0)
+			nTotalSize -= nSize;
+		close(fd);
+		//The lock file is kept, the concurrent requests may hold or wait on it, and
+		//a new lock file would give a later request a lock on another inode
+		string sEntryName = CPLGetFilename(vEntries[i].second.c_str());
+		unlink(GetEntryFileName(sEntryName.substr(0, sEntryName.find('.')), ".key").c_str());
+		unlink(GetEntryFileName(sEntryName.substr(0, sEntryName.find('.')), ".name").c_str());
+	}
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                               LinkFile()                             */
+/************************************************************************/
+
+/**
+ * \brief Make a file available under another name.
+ *
+ * This method is used to hard link a file to another name, the file is
+ * copied if they are on different file systems.
+ *
+ * @param sSrcFileName The path of the existing file.
+ *
+ * @param sDstFileName The new path of the file.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr WCS_Cache::LinkFile(const string& sSrcFileName, const string& sDstFileName)
+{
+	if (link(sSrcFileName.c_str(), sDstFileName.c_str()) == 0 ||
+		CPLCopyFile(sDstFileName.c_str(), sSrcFileName.c_str()) == 0)
+		return CE_None;
+
+	unlink(sDstFileName.c_str());
+	return CE_Failure;
+}
+
+/************************************************************************/
+/*                            GetSizeFromMB()                           */
+/************************************************************************/
+
+/**
+ * \brief Convert a configured size in MB to bytes.
+ *
+ * @param sSizeMB The configured size in MB, empty for default.
+ *
+ * @param nDefaultMB The default size in MB.
+ *
+ * @return The size in bytes.
+ */
+
+GIntBig WCS_Cache::GetSizeFromMB(const string& sSizeMB, int nDefaultMB)
+{
+	return (GIntBig)(sSizeMB.empty() ? nDefaultMB : atoi(sSizeMB.c_str())) * 1024 * 1024;
+}
+
+/************************************************************************/
+/*                              GetSeconds()                            */
+/************************************************************************/
+
+/**
+ * \brief Convert a configured time in seconds.
+ *
+ * @param sSeconds The configured time in seconds, empty for default.
+ *
+ * @param nDefaultSeconds The default time in seconds.
+ *
+ * @return The time in seconds.
+ */
+
+int WCS_Cache::GetSeconds(const string& sSeconds, int nDefaultSeconds)
+{
+	return sSeconds.empty() ? nDefaultSeconds : MAX(0, atoi(sSeconds.c_str()));
+}
+
+/************************************************************************/
+/*                                 Lock()                               */
+/************************************************************************/
+
+/**
+ * \brief Wait for the exclusive lock of a request.
+ *
+ * This method is used to make the identical requests compute one at a
+ * time. It waits until the other process computing the same request
+ * releases the lock, the caller should look up the cache again after it
+ * returns. The lock is released by Unlock() or the destructor. After the
+ * lock timeout, e.g. if the other process is stuck, it gives up and the
+ * caller should compute the request without the cache.
+ *
+ * @param sCanonicalRequest The canonical form of the request.
+ *
+ * @return CE_None on success or CE_Failure on failure or timeout.
+ */
+
+CPLErr WCS_Cache::Lock(const string& sCanonicalRequest)
+{
+	Unlock();
+
+	string sLockFileName = GetEntryFileName(GetKey(sCanonicalRequest), ".lock");
+	int fd = open(sLockFileName.c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd < 0)
+		return CE_Failure;
+
+	if (!FlockWithTimeout(fd, LOCK_EX, mn_LockTimeout))
+	{
+		close(fd);
+		return CE_Failure;
+	}
+	mn_LockFd = fd;
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                                Unlock()                              */
+/************************************************************************/
+
+/**
+ * \brief Release the lock taken by Lock().
+ */
+
+void WCS_Cache::Unlock()
+{
+	if (mn_LockFd < 0)
+		return;
+
+	flock(mn_LockFd, LOCK_UN);
+	close(mn_LockFd);
+	mn_LockFd = -1;
+}
+
+/************************************************************************/
+/*                                  Pin()                               */
+/************************************************************************/
+
+/**
+ * \brief Keep a file from being removed by Evict().
+ *
+ * This method is used to pin a file in the cache while it is read, with a
+ * shared lock on the file. A file is pinned at most once per object, the
+ * pins are released by Unpin() or the destructor. A file being written
+ * could be pinned under its temporary name before it is renamed into the
+ * cache, the pin follows the file.
+ *
+ * @param sFileName The full path of the file.
+ *
+ * @return TRUE if the file exists and is pinned, FALSE otherwise.
+ */
+
+int WCS_Cache::Pin(const string& sFileName)
+{
+	if (mm_PinFds.find(sFileName) != mm_PinFds.end())
+		return TRUE;
+
+	int fd = open(sFileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return FALSE;
+
+	if (!FlockWithTimeout(fd, LOCK_SH, mn_LockTimeout))
+	{
+		close(fd);
+		return FALSE;
+	}
+
+	//The file may have been removed by Evict() before the lock was granted
+	struct stat sStat;
+	if (fstat(fd, &sStat) != 0 || sStat.st_nlink == 0)
+	{
+		close(fd);
+		return FALSE;
+	}
+	mm_PinFds[sFileName] = fd;
+
+	return TRUE;
+}
+
+/************************************************************************/
+/*                                 Unpin()                              */
+/************************************************************************/
+
+/**
+ * \brief Release the pins taken by Pin().
+ */
+
+void WCS_Cache::Unpin()
+{
+	for (map<string, int>::iterator it = mm_PinFds.begin(); it != mm_PinFds.end(); ++it)
+		close(it->second);
+	mm_PinFds.clear();
+}
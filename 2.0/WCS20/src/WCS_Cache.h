@@ -0,0 +1,81 @@
+/******************************************************************************
+ * $Id: WCS_Cache.h $
+ *
+ * Project:  The Open Geospatial Consortium (OGC) Web Coverage Service (WCS)
+ * 			 for Earth Observation: Open Source Reference Implementation
+ * Purpose:  WCS_Cache class definition
+ * Author:   Yuanzheng Shao, yshao3@gmu.edu
+ *
+ ******************************************************************************
+ * Copyright (c) 2011, Liping Di <ldi@gmu.edu>, Yuanzheng Shao <yshao3@gmu.edu>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef WCS_CACHE_H_
+#define WCS_CACHE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "wcsUtil.h"
+
+using namespace std;
+
+/* ******************************************************************** */
+/*                               WCS_Cache                              */
+/* ******************************************************************** */
+
+//! This class is used to cache the outputs of GetCoverage request on local disk.
+
+class WCS_Cache
+{
+protected:
+	string ms_CacheDir;			//Directory of the cached outputs
+	GIntBig mn_MaxSize;			//Size budget of the cache, in bytes
+	int mn_LockTimeout;			//Time to wait for a lock, in seconds
+	int mn_LockFd;				//Lock file held by Lock(), -1 if none
+	map<string, int> mm_PinFds;	//Files pinned by Pin(), with their descriptors
+
+protected:
+	string GetEntryFileName(const string& sKey, const string& sSuffix);
+
+public:
+	WCS_Cache(const string& sCacheDir, GIntBig nMaxSize, int nLockTimeout = 300);
+	~WCS_Cache();
+
+	int IsEnabled();
+	string GetKey(const string& sCanonicalRequest);
+	int Lookup(const string& sCanonicalRequest, const string& sSuffix, string& sCachedFileName, int nMaxAge = -1);
+	CPLErr Store(const string& sCanonicalRequest, const string& sSuffix, const string& sOutFileName);
+	string GetStoredName(const string& sCanonicalRequest);
+	CPLErr Evict();
+	CPLErr Lock(const string& sCanonicalRequest);
+	void Unlock();
+	int Pin(const string& sFileName);
+	void Unpin();
+
+	static CPLErr LinkFile(const string& sSrcFileName, const string& sDstFileName);
+	static GIntBig GetSizeFromMB(const string& sSizeMB, int nDefaultMB);
+	static int GetSeconds(const string& sSeconds, int nDefaultSeconds);
+};
+
+#endif /* WCS_CACHE_H_ */
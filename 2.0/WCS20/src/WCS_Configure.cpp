@@ -506,3 +506,354 @@ string WCS_Configure::Get_KAKADU_COMPRESS_PATH()
 {
 	return map_Config->getValue("KAKADU_COMPRESS_PATH", "");
 }
+
+/************************************************************************/
+/*                         Get_GDAL_CACHE_MAX()                         */
+/************************************************************************/
+
+/**
+ * \brief Fetch the size of GDAL block cache.
+ *
+ * This method will return the maximum size (in megabytes) of the GDAL
+ * raster block cache used when creating output files, including the
+ * gdalwarp and gdal_translate command lines.
+ *
+ * @return String of the cache size in megabytes, empty for GDAL default
+ */
+
+string WCS_Configure::Get_GDAL_CACHE_MAX()
+{
+	return map_Config->getValue("GDAL_CACHE_MAX", "");
+}
+
+/************************************************************************/
+/*                       Get_WARP_MEMORY_LIMIT()                        */
+/************************************************************************/
+
+/**
+ * \brief Fetch the working memory limit of gdalwarp.
+ *
+ * This method will return the memory (in megabytes) gdalwarp is allowed to
+ * use for its working buffer when warping the output chunk by chunk.
+ *
+ * @return String of the memory limit in megabytes, empty for GDAL default
+ */
+
+string WCS_Configure::Get_WARP_MEMORY_LIMIT()
+{
+	return map_Config->getValue("WARP_MEMORY_LIMIT", "");
+}
+
+/************************************************************************/
+/*                        Get_OUTPUT_TILE_SIZE()                        */
+/************************************************************************/
+
+/**
+ * \brief Fetch the tile size of GeoTIFF output.
+ *
+ * This method will return the block size (in pixels) of the tiled GeoTIFF
+ * files created for output and intermediate data.
+ *
+ * @return String of the tile size in pixels, empty for GDAL default (256)
+ */
+
+string WCS_Configure::Get_OUTPUT_TILE_SIZE()
+{
+	return map_Config->getValue("OUTPUT_TILE_SIZE", "");
+}
+
+/************************************************************************/
+/*                      Get_MAX_OUTPUT_DIMENSION()                      */
+/************************************************************************/
+
+/**
+ * \brief Fetch the maximum width or height of output.
+ *
+ * This method will return the maximum width or height (in pixels) allowed
+ * for the output of GetCoverage request. If it is not configured, the size
+ * of the output is not limited.
+ *
+ * @return String of the maximum output dimension in pixels, empty for no limit
+ */
+
+string WCS_Configure::Get_MAX_OUTPUT_DIMENSION()
+{
+	return map_Config->getValue("MAX_OUTPUT_DIMENSION", "");
+}
+
+/************************************************************************/
+/*                       Get_OUTPUT_COMPRESSION()                       */
+/************************************************************************/
+
+/**
+ * \brief Fetch the default compression of GeoTIFF output.
+ *
+ * This method will return the default compression method (NONE, DEFLATE,
+ * ZSTD, LZW or PACKBITS) of GeoTIFF output, which could be overridden by
+ * the "geotiff:compression" parameter of GetCoverage request.
+ *
+ * @return String of the compression method, empty for DEFLATE
+ */
+
+string WCS_Configure::Get_OUTPUT_COMPRESSION()
+{
+	return map_Config->getValue("OUTPUT_COMPRESSION", "");
+}
+
+/************************************************************************/
+/*                    Get_OUTPUT_COMPRESSION_LEVEL()                    */
+/************************************************************************/
+
+/**
+ * \brief Fetch the default compression level of GeoTIFF output.
+ *
+ * This method will return the default compression level of GeoTIFF output
+ * (1-9 for DEFLATE, 1-22 for ZSTD).
+ *
+ * @return String of the compression level, empty for GDAL default
+ */
+
+string WCS_Configure::Get_OUTPUT_COMPRESSION_LEVEL()
+{
+	return map_Config->getValue("OUTPUT_COMPRESSION_LEVEL", "");
+}
+
+/************************************************************************/
+/*                      Get_COMPRESSION_THREADS()                       */
+/************************************************************************/
+
+/**
+ * \brief Fetch the number of threads used to compress output.
+ *
+ * This method will return the number of worker threads used by GDAL to
+ * compress the tiles of GeoTIFF output in parallel.
+ *
+ * @return String of the number of threads, empty for ALL_CPUS
+ */
+
+string WCS_Configure::Get_COMPRESSION_THREADS()
+{
+	return map_Config->getValue("COMPRESSION_THREADS", "");
+}
+
+/************************************************************************/
+/*                         Get_COG_BLOCK_SIZE()                         */
+/************************************************************************/
+
+/**
+ * \brief Fetch the block size of Cloud-Optimized GeoTIFF output.
+ *
+ * This method will return the tile size (in pixels) of Cloud-Optimized
+ * GeoTIFF output, the overviews use the same block size.
+ *
+ * @return String of the block size, empty for OUTPUT_TILE_SIZE or 512
+ */
+
+string WCS_Configure::Get_COG_BLOCK_SIZE()
+{
+	return map_Config->getValue("COG_BLOCK_SIZE", "");
+}
+
+/************************************************************************/
+/*                        Get_CACHE_DIRECTORY()                         */
+/************************************************************************/
+
+/**
+ * \brief Fetch the directory of GetCoverage result cache.
+ *
+ * This method will return the directory where the GetCoverage outputs are
+ * cached, the identical requests will be served from this directory without
+ * processing the coverage again.
+ *
+ * @return String of the cache directory, empty if the cache is disabled
+ */
+
+string WCS_Configure::Get_CACHE_DIRECTORY()
+{
+	return map_Config->getValue("CACHE_DIRECTORY", "");
+}
+
+/************************************************************************/
+/*                         Get_CACHE_MAX_SIZE()                         */
+/************************************************************************/
+
+/**
+ * \brief Fetch the size budget of GetCoverage result cache.
+ *
+ * This method will return the maximum total size (in MB) of the cached
+ * outputs, the least recently used outputs are removed beyond it.
+ *
+ * @return String of the size in MB, empty for 1024
+ */
+
+string WCS_Configure::Get_CACHE_MAX_SIZE()
+{
+	return map_Config->getValue("CACHE_MAX_SIZE", "");
+}
+
+/************************************************************************/
+/*                      Get_TILE_CACHE_DIRECTORY()                      */
+/************************************************************************/
+
+/**
+ * \brief Fetch the directory of the warped tile cache.
+ *
+ * This method will return the directory where the warped tiles of the
+ * coverages are cached. GetCoverage requests in geographic CRS are snapped
+ * to the tile grid and assembled from the cached tiles.
+ *
+ * @return String of the tile cache directory, empty if the tile cache is disabled
+ */
+
+string WCS_Configure::Get_TILE_CACHE_DIRECTORY()
+{
+	return map_Config->getValue("TILE_CACHE_DIRECTORY", "");
+}
+
+/************************************************************************/
+/*                         Get_TILE_GRID_SIZE()                         */
+/************************************************************************/
+
+/**
+ * \brief Fetch the size of the tiles in the tile grid.
+ *
+ * This method will return the size (in degrees) of the tiles in the tile
+ * grid. The grid starts from (-180, 90), and the resolution of the tiles
+ * is derived from the native resolution of each coverage.
+ *
+ * @return String of the tile size in degrees, empty for 1
+ */
+
+string WCS_Configure::Get_TILE_GRID_SIZE()
+{
+	return map_Config->getValue("TILE_GRID_SIZE", "");
+}
+
+/************************************************************************/
+/*                      Get_TILE_CACHE_MAX_SIZE()                       */
+/************************************************************************/
+
+/**
+ * \brief Fetch the size budget of the warped tile cache.
+ *
+ * This method will return the maximum total size (in MB) of the cached
+ * tiles, the least recently used tiles are removed beyond it.
+ *
+ * @return String of the size in MB, empty for 4096
+ */
+
+string WCS_Configure::Get_TILE_CACHE_MAX_SIZE()
+{
+	return map_Config->getValue("TILE_CACHE_MAX_SIZE", "");
+}
+
+/************************************************************************/
+/*                    Get_HDFEOS_COMPRESSION_LEVEL()                    */
+/************************************************************************/
+
+/**
+ * \brief Get the deflate level of HDF-EOS2 output.
+ *
+ * The HDF-EOS2 grid fields are tiled and deflated at this level, 0 disables
+ * the compression. The default level is 6, levels out of 0-9 are clamped.
+ *
+ * @return The deflate level of HDF-EOS2 output, empty for the default.
+ */
+
+string WCS_Configure::Get_HDFEOS_COMPRESSION_LEVEL()
+{
+	return map_Config->getValue("HDFEOS_COMPRESSION_LEVEL", "");
+}
+
+/************************************************************************/
+/*                        Get_JPEG2000_QUALITY()                        */
+/************************************************************************/
+
+/**
+ * \brief Get the quality layers of JPEG2000 output.
+ *
+ * Comma separated list of the quality layers, in percent of the uncompressed
+ * size, e.g. 10,25,50. JPEG2000 output is encoded reversibly when empty.
+ *
+ * @return The quality layers of JPEG2000 output.
+ */
+
+string WCS_Configure::Get_JPEG2000_QUALITY()
+{
+	return map_Config->getValue("JPEG2000_QUALITY", "");
+}
+
+/************************************************************************/
+/*                  Get_GEOLOCATION_CACHE_DIRECTORY()                   */
+/************************************************************************/
+
+/**
+ * \brief Get the directory of the swath geolocation sidecar files.
+ *
+ * The decoded geolocation of swath granules, with their corner points and
+ * footprint, are persisted in this directory. Disabled when empty.
+ *
+ * @return The directory of the swath geolocation sidecar files.
+ */
+
+string WCS_Configure::Get_GEOLOCATION_CACHE_DIRECTORY()
+{
+	return map_Config->getValue("GEOLOCATION_CACHE_DIRECTORY", "");
+}
+
+/************************************************************************/
+/*                   Get_SWATH_NEAREST_MAX_DISTANCE()                   */
+/************************************************************************/
+
+/**
+ * \brief Get the maximum distance of the swath nearest neighbor resampler.
+ *
+ * Output cells farther than this distance (in meters) from the nearest swath
+ * pixel are set to the missing value. The largest spacing of the swath pixels
+ * is used when empty.
+ *
+ * @return The maximum distance of the swath nearest neighbor resampler.
+ */
+
+string WCS_Configure::Get_SWATH_NEAREST_MAX_DISTANCE()
+{
+	return map_Config->getValue("SWATH_NEAREST_MAX_DISTANCE", "");
+}
+
+/************************************************************************/
+/*                      Get_BLOCK_CACHE_MAX_SIZE()                      */
+/************************************************************************/
+
+/**
+ * \brief Fetch the size budget of the decoded block cache.
+ *
+ * This method will return the maximum total size (in MB) of the decoded
+ * source blocks shared by the requests, in the "blocks" directory of the
+ * result cache. The least recently used blocks not in use are removed beyond it.
+ *
+ * @return String of the size in MB, empty for 1024
+ */
+
+string WCS_Configure::Get_BLOCK_CACHE_MAX_SIZE()
+{
+	return map_Config->getValue("BLOCK_CACHE_MAX_SIZE", "");
+}
+
+/************************************************************************/
+/*                       Get_CACHE_LOCK_TIMEOUT()                       */
+/************************************************************************/
+
+/**
+ * \brief Fetch the time to wait for the lock of a cached request.
+ *
+ * This method will return the maximum time (in seconds) a request waits for
+ * an identical request computing the same output. The request is computed
+ * without the cache beyond it, so a stuck process never blocks the others.
+ *
+ * @return String of the time in seconds, empty for 300
+ */
+
+string WCS_Configure::Get_CACHE_LOCK_TIMEOUT()
+{
+	return map_Config->getValue("CACHE_LOCK_TIMEOUT", "");
+}
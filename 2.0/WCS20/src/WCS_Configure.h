@@ -73,6 +73,25 @@ public:
 	string Get_GDAL_TRANSLATE_PATH();
 	string Get_KAKADU_COMPRESS_PATH();
 	string Get_ISO_19115_METADATA_TEMPLATE_PATH();
+	string Get_GDAL_CACHE_MAX();
+	string Get_WARP_MEMORY_LIMIT();
+	string Get_OUTPUT_TILE_SIZE();
+	string Get_MAX_OUTPUT_DIMENSION();
+	string Get_OUTPUT_COMPRESSION();
+	string Get_OUTPUT_COMPRESSION_LEVEL();
+	string Get_COMPRESSION_THREADS();
+	string Get_COG_BLOCK_SIZE();
+	string Get_CACHE_DIRECTORY();
+	string Get_CACHE_MAX_SIZE();
+	string Get_TILE_CACHE_DIRECTORY();
+	string Get_TILE_GRID_SIZE();
+	string Get_TILE_CACHE_MAX_SIZE();
+	string Get_HDFEOS_COMPRESSION_LEVEL();
+	string Get_JPEG2000_QUALITY();
+	string Get_GEOLOCATION_CACHE_DIRECTORY();
+	string Get_SWATH_NEAREST_MAX_DISTANCE();
+	string Get_BLOCK_CACHE_MAX_SIZE();
+	string Get_CACHE_LOCK_TIMEOUT();
 
 	string GetConfigureFileName();
 };
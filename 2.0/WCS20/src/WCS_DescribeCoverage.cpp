@@ -29,6 +29,9 @@
  ****************************************************************************/
 
 #include "WCS_DescribeCoverage.h"
+#include "WCS_Cache.h"
+
+#include <unistd.h>
 
 /************************************************************************/
 /* ==================================================================== */
@@ -658,6 +661,31 @@ void WCS_DescribeCoverage::WCST_Respond(string& sOutFileName)
 
 void WCS_DescribeCoverage::WCST_Respond()
 {
+	//Single flight for DescribeEOCoverageSet: the identical concurrent requests wait for
+	//the first one and are served by its response, which is only reused while they wait
+	string sCacheDir = mp_Conf->Get_CACHE_DIRECTORY();
+	WCS_Cache oCache(sCacheDir, WCS_Cache::GetSizeFromMB(mp_Conf->Get_CACHE_MAX_SIZE(), 1024),
+			WCS_Cache::GetSeconds(mp_Conf->Get_CACHE_LOCK_TIMEOUT(), 300));
+	string sCanonicalRequest;
+	if (mb_DescribeEOCoverage && oCache.IsEnabled())
+		sCanonicalRequest = GetCanonicalRequest();
+
+	//The response is computed without the cache if the first request does not finish in time
+	time_t tStart = time(NULL);
+	if (!sCanonicalRequest.empty() && CE_None != oCache.Lock(sCanonicalRequest))
+		sCanonicalRequest = "";
+	if (!sCanonicalRequest.empty())
+	{
+		string sCachedFileName;
+		if (oCache.Lookup(sCanonicalRequest, ".xml", sCachedFileName, (int)(time(NULL) - tStart)))
+		{
+			oCache.Unlock();
+			ifstream cachedFile(sCachedFileName.c_str());
+			cout << cachedFile.rdbuf() << endl;
+			return;
+		}
+	}
+
 	ostringstream osstrm;
 
 	osstrm <<"Content-Type: text/xml"<<endl<<endl;
@@ -670,7 +698,50 @@ void WCS_DescribeCoverage::WCST_Respond()
 		return;
 	}
 
+	if (!sCanonicalRequest.empty())
+	{
+		int nPid = (int)getpid();
+		string sTmpFileName = CPLFormFilename(sCacheDir.c_str(), (oCache.GetKey(sCanonicalRequest) + "." +
+				convertToString(nPid) + ".xml.tmp").c_str(), NULL);
+		ofstream tmpFile(sTmpFileName.c_str());
+		tmpFile << osstrm.str();
+		tmpFile.close();
+		if (tmpFile)
+			oCache.Store(sCanonicalRequest, ".xml", sTmpFileName);
+		unlink(sTmpFileName.c_str());
+		oCache.Unlock();
+	}
+
 	cout << osstrm.str()<<endl;
 
 	return;
 }
+
+/************************************************************************/
+/*                         GetCanonicalRequest()                        */
+/************************************************************************/
+
+/**
+ * \brief Fetch the canonical form of the DescribeEOCoverageSet request.
+ *
+ * This method is used to build the key which identifies the identical
+ * DescribeEOCoverageSet requests, made of the EO identifiers and the
+ * spatial and temporal subsets.
+ *
+ * @return The canonical request.
+ */
+
+string WCS_DescribeCoverage::GetCanonicalRequest()
+{
+	string sCanonical = "request=DescribeEOCoverageSet\neoid=";
+	for (size_t i = 0; i < mv_CovIDs.size(); i++)
+		sCanonical += mv_CovIDs[i] + ",";
+	sCanonical += "\n";
+	if (mB_SubsetSpatialLon)
+		sCanonical += CPLString().Printf("lon=%.12g,%.12g\n", md_RequestMinX, md_RequestMaxX);
+	if (mB_SubsetSpatialLat)
+		sCanonical += CPLString().Printf("lat=%.12g,%.12g\n", md_RequestMinY, md_RequestMaxY);
+	sCanonical += "time=" + ms_RequestBeginTime + "," + ms_RequestEndTime + "\n";
+
+	return sCanonical;
+}
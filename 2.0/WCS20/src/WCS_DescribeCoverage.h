@@ -76,6 +76,7 @@ public:
 	CPLErr CreateDescribeCoverageXMLTree(ostringstream& outStream);
 
 	string CreateDescibeCoverageXMLByCoverageID(string coverageID);
+	string GetCanonicalRequest();
 
 };
 
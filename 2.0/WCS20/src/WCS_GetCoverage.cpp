@@ -30,12 +30,16 @@
 
 #include "WCS_GetCoverage.h"
 #include "WCS_DescribeCoverage.h"
+#include "WCS_GetStoredCoverage.h"
 
 #include <math.h>
 #include <iostream>
 #include <fstream>
+#include <set>
+#include <utime.h>
 #include "hdf.h"
 #include "mfhdf.h"
+#include "HdfEosDef.h"
 
 /************************************************************************/
 /* ==================================================================== */
@@ -75,6 +79,8 @@ WCS_GetCoverage::WCS_GetCoverage(const string& conf) :
 	ms_CovID = "";
 	ms_RequestCRS_URN = "";
 	ms_ResponseCRS_URN = "";
+	mp_RequestedRegCRS = NULL;
+	mp_ResponseRegCRS = NULL;
 	mvi_BandList.clear();
 	ms_OutputFormat = "";
 	mb_SubsetSpatial = false;
@@ -83,6 +89,16 @@ WCS_GetCoverage::WCS_GetCoverage(const string& conf) :
 
 	ms_Interpolation = "near";//GDALWARP rules
 	me_Interplation = GRA_NearestNeighbour;
+
+	ms_Compression = "";
+	ms_CompressionLevel = "";
+	ms_Predictor = "";
+
+	ms_TileGridKey = "";
+	ms_TileCRS_URN = "";
+	md_TileSize = 0.0;
+	mi_TilePixels = 0;
+	mi_TileMinX = mi_TileMinY = mi_TileMaxX = mi_TileMaxY = 0;
 }
 
 WCS_GetCoverage::~WCS_GetCoverage()
@@ -347,15 +363,61 @@ CPLErr WCS_GetCoverage::GetReqMessageFromURLString(const string& urlStr)
 		}
 	}
 
+	//GeoTIFF encoding extension, geotiff:compression=Deflate&geotiff:compressionLevel=6
+	tmpStr = kvps.getValue("geotiff:compression", "");
+	if(tmpStr != "")
+	{
+		if(!EQUAL(tmpStr.c_str(), "None") && !EQUAL(tmpStr.c_str(), "Deflate") && !EQUAL(tmpStr.c_str(), "ZSTD") &&
+			!EQUAL(tmpStr.c_str(), "LZW") && !EQUAL(tmpStr.c_str(), "PackBits"))
+		{
+			SetWCS_ErrorLocator("geotiff:compression");
+			WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "Invalid Parameter Value of geotiff:compression, please select from \"None\", \"Deflate\", \"ZSTD\", \"LZW\" and \"PackBits\".");
+			return CE_Failure;
+		}
+		ms_Compression = CPLString(tmpStr).toupper();
+	}
+
+	tmpStr = kvps.getValue("geotiff:compressionLevel", "");
+	if(tmpStr != "")
+	{
+		int nLevel = atoi(tmpStr.c_str());
+		if(nLevel < 1 || nLevel > 22)
+		{
+			SetWCS_ErrorLocator("geotiff:compressionLevel");
+			WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "Invalid Parameter Value of geotiff:compressionLevel.");
+			return CE_Failure;
+		}
+		ms_CompressionLevel = convertToString(nLevel);
+	}
+
+	tmpStr = kvps.getValue("geotiff:predictor", "");
+	if(tmpStr != "")
+	{
+		if(EQUAL(tmpStr.c_str(), "None"))
+			ms_Predictor = "1";
+		else if(EQUAL(tmpStr.c_str(), "Horizontal"))
+			ms_Predictor = "2";
+		else if(EQUAL(tmpStr.c_str(), "FloatingPoint"))
+			ms_Predictor = "3";
+		else
+		{
+			SetWCS_ErrorLocator("geotiff:predictor");
+			WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "Invalid Parameter Value of geotiff:predictor, please select from \"None\", \"Horizontal\" and \"FloatingPoint\".");
+			return CE_Failure;
+		}
+	}
+
 	ms_ResponseCRS_URN = kvps.getValue("OUTPUTCRS", "");
 	if(ms_ResponseCRS_URN != "")
 	{
-		if (OGRERR_NONE != mo_ResponseCRS.SetFromUserInput(ms_ResponseCRS_URN.c_str()))
+		mp_ResponseRegCRS = GetRegisteredCRS(ms_ResponseCRS_URN.c_str());
+		if (NULL == mp_ResponseRegCRS)
 		{
 			SetWCS_ErrorLocator("OUTPUTCRS");
 			WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "Invalid Parameter Value of OUTPUTCRS.");
 			return CE_Failure;
 		}
+		mo_ResponseCRS = mp_ResponseRegCRS->mo_SRS;
 	}
 
 	tmpStr = kvps.getValue("rangesubset", "");
@@ -420,12 +482,14 @@ CPLErr WCS_GetCoverage::GetReqMessageFromURLString(const string& urlStr)
 
 	if(ms_RequestCRS_URN != "")
 	{
-		if (OGRERR_NONE != mo_RequestedCRS.SetFromUserInput(ms_RequestCRS_URN.c_str()))
+		mp_RequestedRegCRS = GetRegisteredCRS(ms_RequestCRS_URN.c_str());
+		if (NULL == mp_RequestedRegCRS)
 		{
 			SetWCS_ErrorLocator("subsetRequestCRS");
 			WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "Invalid Parameter Value of Request CRS.");
 			return CE_Failure;
 		}
+		mo_RequestedCRS = mp_RequestedRegCRS->mo_SRS;
 	}
 
 	return CE_None;
@@ -484,6 +548,12 @@ CPLErr WCS_GetCoverage::CreateISO19115Metadata(DatasetObject dsObj)
 
 CPLErr WCS_GetCoverage::CreateEOMetadata(const string& sOutFileName)
 {
+	//The statistics of GOES are computed on the output, without writing them next to it
+	int bGOESData = ms_CovGDALID.find("GOES:NETCDF") != string::npos ? true : false;
+	const char* pszOldPam = CPLGetConfigOption("GDAL_PAM_ENABLED", NULL);
+	CPLString osOldPam = pszOldPam ? pszOldPam : "";
+	if(bGOESData)
+		CPLSetThreadLocalConfigOption("GDAL_PAM_ENABLED", "NO");
 	GDALDataset* outDS = (GDALDataset*) GDALOpen(sOutFileName.c_str(), GA_ReadOnly);
 	AbstractDataset* absDS = WCSTCreateDataset(ms_CovGDALID, mvi_BandList, 1);
 	string covSubType = absDS->GetCoverageSubType();
@@ -557,8 +627,10 @@ CPLErr WCS_GetCoverage::CreateEOMetadata(const string& sOutFileName)
 	outStream << "    <swe:DataRecord>" <<endl;
 	for(int i = 1; i <= fields; i++)
 	{
+		//The allowed values of GOES are taken from the output, the scan is rectified on the fly
 		double dfMin=0.0, dfMax=0.0, dfMean=0.0, dfStdDev=0.0;
-		GDALRasterBandH	hBand = GDALGetRasterBand(absDS->GetGDALDataset(), i);
+		GDALRasterBandH	hBand = bGOESData && i <= outDS->GetRasterCount() ?
+				GDALGetRasterBand(outDS, i) : GDALGetRasterBand(absDS->GetGDALDataset(), i);
 		GDALGetRasterStatistics( hBand, true, true, &dfMin, &dfMax, &dfMean, &dfStdDev );
 	outStream << "     <swe:field name=\"" << StrTrims(absDS->GetDatasetName(), "\"") + "_field_" + convertToString(i) << "\">" <<endl;
 	outStream << "        <swe:Quantity definition=\"http://www.opengis.net/def/property/OGC/0/" << absDS->GetFieldQuantityDef() << "\">" <<endl;
@@ -592,6 +664,8 @@ CPLErr WCS_GetCoverage::CreateEOMetadata(const string& sOutFileName)
 
 	WCSTDestroyDataset(absDS);
 	GDALClose(outDS);
+	if(bGOESData)//restore the setting of the caller
+		CPLSetThreadLocalConfigOption("GDAL_PAM_ENABLED", pszOldPam ? osOldPam.c_str() : NULL);
 
 	return CE_None;
 }
@@ -607,12 +681,30 @@ CPLErr WCS_GetCoverage::CreateEOMetadata(const string& sOutFileName)
  * on coverage identifier and band list, also query the DatasetObject
  * from the dataset/datasetSeries configuration files.
  *
+ * For TRMM coverage, the time subset is resolved to the band list before
+ * the dataset is created, so only the selected days or 3-hourly slots
+ * will be read from the source file.
+ *
  * @return CE_None on success or CE_Failure on failure.
  */
 
 CPLErr WCS_GetCoverage::GetCoverageInitial()
 {
-	AbstractDataset* absDS = WCSTCreateDataset(ms_CovID.c_str(), mvi_BandList, 0);;
+	if (EQUALN(ms_CovID.c_str(), "TRMM:", 5) && mvi_BandList.empty() &&
+		(!EQUAL(ms_RequestBeginTime.c_str(), "") || !EQUAL(ms_RequestEndTime.c_str(), "")))
+	{
+		vector<string> strSet;
+		CsvburstCpp(ms_CovID, strSet, ':');
+		CPLErr eErr = EQUAL(strSet.back().c_str(), "Daily") ?
+			GetTRMMBandList(ms_RequestBeginTime, ms_RequestEndTime, mvi_BandList) :
+			GetTRMM3HourlyBandList(ms_RequestBeginTime, ms_RequestEndTime, mvi_BandList);
+		if (eErr != CE_None)
+			return CE_Failure;
+	}
+
+	AbstractDataset* absDS = WCSTCreateDataset(ms_CovID.c_str(), mvi_BandList, 0);
+	if (absDS == NULL)
+		return CE_Failure;
 	mp_AbsDS.reset(absDS);
 
 	double geomatrix[6];
@@ -658,6 +750,8 @@ CPLErr WCS_GetCoverage::GetCoverageInitial()
  * \brief Delivery the output file stream to user directly.
  *
  * This method is used to delivery the output file stream to user directly.
+ * The headers are written with a single writev(), and the file content is
+ * transferred with sendfile()/splice() by HttpWriteResponse().
  *
  * @param sOutFileName The path of the response file needs to be delivered..
  *
@@ -666,8 +760,8 @@ CPLErr WCS_GetCoverage::GetCoverageInitial()
 
 CPLErr WCS_GetCoverage::HttpDirectoryRespond(const string& sOutFileName)
 {
-	ifstream ifs(sOutFileName.c_str(), ios::binary);
-	if (!ifs)
+	GIntBig filesize = GetFileByteSize(sOutFileName);
+	if (filesize < 0)
 	{
 		SetWCS_ErrorLocator("WCS_GetCoverage::HttpDirectoryRespond()");
 		WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue,
@@ -676,19 +770,14 @@ CPLErr WCS_GetCoverage::HttpDirectoryRespond(const string& sOutFileName)
 		return CE_Failure;
 	}
 
-	long temp = ifs.tellg();
-	ifs.seekg(0, ios_base::end);
-	long filesize = ifs.tellg();
-	ifs.seekg(0, ios::beg);
-
 	ms_OutputContentType += "\r\nContent-Disposition: attachment; filename=";
 	ms_OutputContentType += CPLGetFilename(sOutFileName.c_str());
 
-	cout << "Content-Length: " << filesize << endl;
-	cout << ms_OutputContentType << endl << endl;
-	cout << ifs.rdbuf() << endl;
+	vector<string> head, tail;
+	head.push_back("Content-Length: " + convertToString(filesize) + "\r\n");
+	head.push_back(ms_OutputContentType + "\r\n\r\n");
 
-	return CE_None;
+	return HttpWriteResponse(head, sOutFileName, 0, filesize, tail);
 }
 
 /************************************************************************/
@@ -698,7 +787,10 @@ CPLErr WCS_GetCoverage::HttpDirectoryRespond(const string& sOutFileName)
 /**
  * \brief Delivery the output file URL to user.
  *
- * This method is used to delivery the output file URL to user.
+ * This method is used to delivery the output file URL to user. The content
+ * hash of the output is recorded as its ETag. If OUTPUT_PREFIX_URL is not
+ * configured, the URL refers to the GetStoredCoverage request of this WCS,
+ * which delivers the output with HTTP Range support.
  *
  * @param sOutFileName The path of the response file needs to be delivered..
  *
@@ -707,8 +799,16 @@ CPLErr WCS_GetCoverage::HttpDirectoryRespond(const string& sOutFileName)
 
 CPLErr WCS_GetCoverage::HttpStoreRespond(const string& sOutFileName)
 {
+	if (CE_None != WCSTWriteStoredCoverageTag(sOutFileName, ms_OutputContentType))
+		return CE_Failure;
+
 	string TMPURL = mp_Conf->Get_OUTPUT_PREFIX_URL();
-	string sTmpOutFileName = TMPURL + CPLGetFilename(sOutFileName.c_str());
+	string sTmpOutFileName;
+	if (EQUAL(TMPURL.c_str(), ""))
+		sTmpOutFileName = mp_Conf->Get_SERVICE_ACCESS_URL() +
+			"service=WCS%26version=2.0.0%26request=GetStoredCoverage%26storedId=" + CPLGetFilename(sOutFileName.c_str());
+	else
+		sTmpOutFileName = TMPURL + CPLGetFilename(sOutFileName.c_str());
 
 	string oTmp;
 	oTmp = "<Coverages xmlns=\"http://www.opengis.net/wcs/2.0\"\n";
@@ -758,9 +858,8 @@ CPLErr WCS_GetCoverage::HttpStoreRespond(const string& sOutFileName)
 
 CPLErr WCS_GetCoverage::HttpMultiPartsDirectoryRespond(const string& sOutFileName)
 {
-	ifstream ifs(sOutFileName.c_str(), ios::binary);
-	string filename = string(CPLGetFilename(sOutFileName.c_str()));
-	if (!ifs)
+	GIntBig filesize = GetFileByteSize(sOutFileName);
+	if (filesize < 0)
 	{
 		SetWCS_ErrorLocator("WCS_GetCoverage::HttpMultiPartsDirectoryRespond()");
 		WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue,
@@ -770,25 +869,83 @@ CPLErr WCS_GetCoverage::HttpMultiPartsDirectoryRespond(const string& sOutFileNam
 
 	CreateEOMetadata(sOutFileName);
 
-	int temp = ifs.tellg();
-	ifs.seekg(0, ios_base::end);
-	long filesize = ifs.tellg();
-	ifs.seekg(0, ios::beg);
-
 	ms_OutputContentType += "\r\nContent-Disposition: attachment; filename=";
 	ms_OutputContentType += CPLGetFilename(sOutFileName.c_str());
 
-	cout << "Content-Type: multipart/mixed; boundary=\"gmueowcs\"" << endl << endl;
-	cout << "--gmueowcs" << endl;
-	cout << "Content-Length: " << filesize << endl;
-	cout << ms_OutputContentType << endl << endl;
-	cout << ifs.rdbuf() <<endl;
-	cout << "--gmueowcs" << endl;
-	cout << "Content-Type: text/xml" << endl << endl;
-	cout << ms_eoMetadataContents << endl << endl;
-	cout << "--gmueowcs--" << endl;
+	vector<string> head, tail;
+	head.push_back("Content-Type: multipart/mixed; boundary=\"gmueowcs\"\r\n\r\n");
+	head.push_back("--gmueowcs\r\n");
+	head.push_back("Content-Length: " + convertToString(filesize) + "\r\n");
+	head.push_back(ms_OutputContentType + "\r\n\r\n");
 
-	return CE_None;
+	tail.push_back("\r\n--gmueowcs\r\n");
+	tail.push_back("Content-Type: text/xml\r\n\r\n");
+	tail.push_back(ms_eoMetadataContents);
+	tail.push_back("\r\n\r\n--gmueowcs--\r\n");
+
+	return HttpWriteResponse(head, sOutFileName, 0, filesize, tail);
+}
+
+/************************************************************************/
+/*                          IsPassthroughRequest()                      */
+/************************************************************************/
+
+/**
+ * \brief Determine whether the source file could be delivered as is.
+ *
+ * This method is used to determine whether the request asks for the
+ * whole coverage without any spatial, temporal or band subsetting,
+ * scaling or re-projection, in the native format of the coverage. In
+ * that case, the warp/translate/copy chain would reproduce the source
+ * file, so the source file will be delivered directly.
+ *
+ * @return TRUE if the source file could be delivered, otherwise FALSE.
+ */
+
+int WCS_GetCoverage::IsPassthroughRequest()
+{
+	if (!mp_AbsDS.get() || !mp_AbsDS->IsWholeFileCoverage())
+		return FALSE;
+
+	if (mb_SubsetSpatial || mb_IsStore || mb_MultiPart ||
+		!mvi_BandList.empty() || !mvi_OutputWH.empty() || !mvd_OutputResXY.empty() ||
+		!EQUAL(ms_RequestBeginTime.c_str(), "") || !EQUAL(ms_RequestEndTime.c_str(), ""))
+		return FALSE;
+
+	if (!EQUAL(ms_OutputFormatCode.c_str(), mp_AbsDS->GetNativeFormat().c_str()))
+		return FALSE;
+
+	if (ms_ResponseCRS_URN != "" && !mo_ResponseCRS.IsSame(&mp_AbsDS->GetNativeCRS()))
+		return FALSE;
+
+	return TRUE;
+}
+
+/************************************************************************/
+/*                         HttpPassthroughRespond()                     */
+/************************************************************************/
+
+/**
+ * \brief Delivery the source file of the coverage to user directly.
+ *
+ * This method is used to delivery the unmodified source file of the
+ * coverage to user with sendfile(). The HTTP Range header is honored,
+ * so a download could be resumed.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr WCS_GetCoverage::HttpPassthroughRespond()
+{
+	string sSrcFileName = mp_AbsDS->GetResourceFileName();
+
+	string sContentType = ms_OutputContentType;
+	sContentType += "\r\nContent-Disposition: attachment; filename=";
+	sContentType += CPLGetFilename(sSrcFileName.c_str());
+
+	const char* pszRange = getenv("HTTP_RANGE");
+
+	return HttpSendFile(sSrcFileName, sContentType, pszRange ? pszRange : "");
 }
 
 /************************************************************************/
@@ -815,7 +972,7 @@ CPLErr WCS_GetCoverage::SetCRSFromURN(OGRSpatialReference& crs_ID, const char* C
 
 	if (Find_Compare_SubStr(CRS_urn, "OGC:") && Find_Compare_SubStr(CRS_urn, ":84"))
 	{
-		crs_ID.SetWellKnownGeogCS("WGS84");
+		ImportRegisteredCRS(crs_ID, "WGS84");
 		return CE_None;
 	}
 	else if (Find_Compare_SubStr(CRS_urn, ":IMAGECRS"))
@@ -823,7 +980,7 @@ CPLErr WCS_GetCoverage::SetCRSFromURN(OGRSpatialReference& crs_ID, const char* C
 		crs_ID.SetLocalCS("OGC:imageCRS");
 		return CE_None;
 	}
-	else if (OGRERR_NONE == crs_ID.SetFromUserInput(CRS_urn))
+	else if (OGRERR_NONE == ImportRegisteredCRS(crs_ID, CRS_urn))
 		return CE_None;
 	else
 	{
@@ -858,6 +1015,14 @@ string WCS_GetCoverage::CreateOutputFileSuffix()
 		ms_OutputContentType = "Content-Type: image/tiff";
 		return ".tif";
 	}
+	else if (EQUAL(ms_OutputFormat.c_str(), "COG") ||
+			EQUAL(ms_OutputFormat.c_str(), "x-cog") ||
+			ms_OutputFormat.find("profile=cloud-optimized") != string::npos)
+	{
+		ms_OutputFormatCode = "COG";
+		ms_OutputContentType = "Content-Type: image/tiff; application=geotiff; profile=cloud-optimized";
+		return ".tif";
+	}
 	else if (EQUAL(ms_OutputFormat.c_str(),"NetCDF") ||
 			EQUAL(ms_OutputFormat.c_str(),"x-netcdf"))
 	{
@@ -920,7 +1085,7 @@ string WCS_GetCoverage::CreateOutputFileSuffix()
 	}
 	else if (EQUAL(ms_OutputFormat.c_str(),"x-hdfeos"))
 	{
-		ms_OutputFormatCode = "HDFEOS";//GDAL do not support HDF-EOS export, will be re-written.
+		ms_OutputFormatCode = "HDFEOS";//GDAL do not support HDF-EOS export, written by CreateHDFEOS2File()
 		ms_OutputContentType = "Content-Type: application/x-hdfeos";
 		return ".hdf";
 	}
@@ -930,8 +1095,13 @@ string WCS_GetCoverage::CreateOutputFileSuffix()
 		ms_OutputContentType = "Content-Type: text/xml";
 		return ".jp2";
 	}
-	else if (EQUAL(ms_OutputFormat.c_str(),"Binary"))
+	else if (EQUAL(ms_OutputFormat.c_str(),"Binary") ||
+			EQUAL(ms_OutputFormat.c_str(),"octet-stream"))
+	{
+		ms_OutputFormatCode = "BINARY";//Written by CreateBinaryFile()
+		ms_OutputContentType = "Content-Type: application/octet-stream";
 		return ".dat";
+	}
 	else
 	{
 		ms_OutputFormatCode = "";
@@ -948,37 +1118,117 @@ string WCS_GetCoverage::CreateOutputFileSuffix()
 /**
  * \brief Create the file in binary stream.
  *
- * This method is used to create the file in binary stream.
-
+ * This method is used to write the warp result as a self-describing binary
+ * stream, which could be memory mapped by the clients. The file starts with
+ * a 128 bytes header, all the numbers in the byte order of the server:
+ *
+ *   0  char[8]   magic, "WCSBIN01"
+ *   8  uint32    byte order mark, 0x01020304
+ *  12  uint32    offset of the data, the 128 bytes header and the CRS WKT
+ *                rounded up to a multiple of 64 bytes
+ *  16  uint32    width, height, band count
+ *  28  uint32    GDAL data type, size of a sample in bytes, nodata flag
+ *  40  double[6] geotransform
+ *  88  double    nodata value
+ *  96  uint32    length of the CRS WKT, including the terminating zero
+ * 100  reserved, zero
+ * 128  CRS WKT, then zero padding up to the offset of the data
+ *
+ * The bands follow from the offset of the data, one after another, each row
+ * by row from the top. They are streamed block by block, so the memory used
+ * is bounded by one row of blocks of the warp result.
+ *
+ * @param sSourceFile The path of the warp result.
+ *
+ * @param sOutFileName The path of the binary file to be created.
+ *
  * @return CE_None on success or CE_Failure on failure.
  */
 
-CPLErr WCS_GetCoverage::CreateBinaryFile(const string &sOutFileName)
+CPLErr WCS_GetCoverage::CreateBinaryFile(const string& sSourceFile, const string& sOutFileName)
 {
-	int nXSize = mp_AbsDS->GetImageXSize();
-	int nYSize = mp_AbsDS->GetImageYSize();
-
-	int nband = mp_AbsDS->GetImageBandCount();
-	GDALDataType eDataType = mp_AbsDS->GetGDALDataset()->GetRasterBand(1)->GetRasterDataType();
-	int bufSize = nXSize * nYSize * GDALGetDataTypeSize(eDataType) / 8;
-	char *pData = (char *) CPLMalloc(bufSize);
-	if (pData == NULL)
+	GDALDataset* dsSource = (GDALDataset*) GDALOpen(sSourceFile.c_str(), GA_ReadOnly);
+	if (!dsSource || dsSource->GetRasterCount() < 1)
+	{
+		if (dsSource)
+			GDALClose(dsSource);
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateBinaryFile()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to open the warp result.");
 		return CE_Failure;
+	}
+
+	GUInt32 nXSize = dsSource->GetRasterXSize();
+	GUInt32 nYSize = dsSource->GetRasterYSize();
+	GUInt32 nBand = dsSource->GetRasterCount();
+	GDALRasterBand* poBand = dsSource->GetRasterBand(1);
+	GDALDataType eDataType = poBand->GetRasterDataType();
+	GUInt32 nDataType = eDataType;
+	GUInt32 nDTSize = GDALGetDataTypeSize(eDataType) / 8;
+
+	int bHasNoData = FALSE;
+	double dfNoData = poBand->GetNoDataValue(&bHasNoData);
+	if (!bHasNoData)
+		dfNoData = mp_AbsDS->GetMissingValue();
+	GUInt32 nHasNoData = bHasNoData;
+
+	double adfGeoTransform[6];
+	dsSource->GetGeoTransform(adfGeoTransform);
+	string sWKT = dsSource->GetProjectionRef();
+	GUInt32 nWKTLength = sWKT.length() + 1;
+	GUInt32 nDataOffset = (128 + nWKTLength + 63) / 64 * 64;
+	GUInt32 nByteOrder = 0x01020304;
+
+	vector<char> header(nDataOffset, 0);
+	memcpy(&header[0], "WCSBIN01", 8);
+	memcpy(&header[8], &nByteOrder, 4);
+	memcpy(&header[12], &nDataOffset, 4);
+	memcpy(&header[16], &nXSize, 4);
+	memcpy(&header[20], &nYSize, 4);
+	memcpy(&header[24], &nBand, 4);
+	memcpy(&header[28], &nDataType, 4);
+	memcpy(&header[32], &nDTSize, 4);
+	memcpy(&header[36], &nHasNoData, 4);
+	memcpy(&header[40], adfGeoTransform, 48);
+	memcpy(&header[88], &dfNoData, 8);
+	memcpy(&header[96], &nWKTLength, 4);
+	memcpy(&header[128], sWKT.c_str(), nWKTLength);
 
 	ofstream datafile(sOutFileName.c_str(), ios::binary);
+	datafile.write(&header[0], nDataOffset);
+
+	//Stream one row of blocks at a time
+	int nBlockXSize, nBlockYSize;
+	poBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
+	int nRows = MAX(1, MIN(nBlockYSize, (int)nYSize));
+	char *pData = (char *) VSIMalloc3(nXSize, nRows, nDTSize);
 
-	for (int i = 1; i <= nband; i++)
+	CPLErr eErr = (pData && datafile.good()) ? CE_None : CE_Failure;
+	for (int i = 1; i <= (int)nBand && eErr == CE_None; i++)
 	{
-		if (CE_None != mp_AbsDS->GetGDALDataset()->GetRasterBand(i)->RasterIO(
-				GF_Read, 0, 0, nXSize, nYSize, pData, nXSize, nYSize, eDataType, 0, 0))
+		for (int row = 0; row < (int)nYSize && eErr == CE_None; row += nRows)
 		{
-			VSIFree((char*) pData);
-			return CE_Failure;
+			int nLines = MIN(nRows, (int)nYSize - row);
+			eErr = dsSource->GetRasterBand(i)->RasterIO(GF_Read, 0, row, nXSize, nLines,
+					pData, nXSize, nLines, eDataType, 0, 0);
+			if (eErr == CE_None)
+			{
+				datafile.write(pData, (streamsize)nXSize * nLines * nDTSize);
+				if (!datafile.good())
+					eErr = CE_Failure;
+			}
 		}
-		datafile.write(pData, bufSize);
 	}
 
-	VSIFree((char*) pData);
+	VSIFree(pData);
+	datafile.close();
+	GDALClose(dsSource);
+
+	if (eErr != CE_None)
+	{
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateBinaryFile()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to write the binary file.");
+		return CE_Failure;
+	}
 
 	return CE_None;
 }
@@ -994,10 +1244,38 @@ double decimal2PDF(double llcoord)
 	return degree * 1000000 + minute * 1000 + second;
 }
 
+/************************************************************************/
+/*                          CreateHDFEOS2File()                         */
+/************************************************************************/
+
+/**
+ * \brief Create the HDF-EOS2 grid file from the warp result.
+ *
+ * This method is used to write the warp result to an HDF-EOS2 grid, one
+ * field per band. The fields are tiled (OUTPUT_TILE_SIZE, 256 by default)
+ * and compressed with deflate at HDFEOS_COMPRESSION_LEVEL (0 for none).
+ * Each band is streamed through one row of tiles at a time, so the memory
+ * used is bounded by the width of the output times the tile height rather
+ * than the size of the band. The HDF library is not thread safe, so the
+ * bands are written one after another.
+ *
+ * @param sSourceFile The path of the warp result.
+ *
+ * @param hdfeosFile The path of the HDF-EOS2 file to be created.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
 CPLErr WCS_GetCoverage::CreateHDFEOS2File(const string& sSourceFile, string hdfeosFile)
 {
-	/*
 	GDALDataset* dsSource = (GDALDataset*) GDALOpen(sSourceFile.c_str(), GA_ReadOnly);
+	if(!dsSource)
+	{
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateHDFEOS2File()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to open the warp result.");
+		return CE_Failure;
+	}
+
 	double fill = mp_AbsDS->GetMissingValue();
 	int bands = dsSource->GetRasterCount();
 	int x = dsSource->GetRasterXSize();
@@ -1005,25 +1283,27 @@ CPLErr WCS_GetCoverage::CreateHDFEOS2File(const string& sSourceFile, string hdfe
 
 	string gridname = mp_AbsDS->GetDataTypeName();
 	string fieldname= mp_AbsDS->GetDatasetName();
+	if(EQUAL(gridname.c_str(), ""))
+		gridname = "Grid";
+	if(EQUAL(fieldname.c_str(), ""))
+		fieldname = "Band";
 
 	double gt[6];
 	dsSource->GetGeoTransform(gt);
 
 	OGRSpatialReference sr(dsSource->GetProjectionRef());
-	char *psTargetSRS;
-	sr.exportToWkt(&psTargetSRS);
 
 	float64 xmin = gt[0];
 	float64 xmax = gt[0] + x * gt[1];
 	float64 ymax = gt[3];
 	float64 ymin = gt[3] + y * gt[5];
 
-	int32 gdIDout;
-	int32 fileIDout, status;
+	int32 gdIDout = FAIL;
+	int32 fileIDout = FAIL;
 	double *projParameter = NULL;
 	int32 projCode,zoneCode,sphereCode,originCode=0;
 	float64 upperLeft[2], lowerRight[2];
-	long int projCode_l,zoneCode_l,sphereCode_l;
+	long int projCode_l = 0,zoneCode_l = 0,sphereCode_l = 0;
 
 	sr.exportToUSGS(&projCode_l, &zoneCode_l, &projParameter, &sphereCode_l);
 
@@ -1041,120 +1321,122 @@ CPLErr WCS_GetCoverage::CreateHDFEOS2File(const string& sSourceFile, string hdfe
 		lowerRight[0] = xmax; lowerRight[1] = ymin;
 	}
 
-	char fieldDimList[32] = {"YDim,XDim"};
-	int32 edge[2] = {y, x};
+	//Tiling and compression of the fields
+	string sTileSize = mp_Conf->Get_OUTPUT_TILE_SIZE();
+	int tilesize = EQUAL(sTileSize.c_str(), "") ? 256 : atoi(sTileSize.c_str());
+	int32 tiledims[2] = {MAX(1, MIN(tilesize, y)), MAX(1, MIN(tilesize, x))};
+	string sCompLevel = mp_Conf->Get_HDFEOS_COMPRESSION_LEVEL();
+	int complevel = EQUAL(sCompLevel.c_str(), "") ? 6 : MAX(0, MIN(9, atoi(sCompLevel.c_str())));//deflate levels
+	intn compparm[5] = {complevel, 0, 0, 0, 0};
 
 	if((fileIDout = GDopen((char*)hdfeosFile.c_str(), DFACC_CREATE)) == FAIL ||
 	 (gdIDout = GDcreate(fileIDout, (char*)gridname.c_str(), x, y, upperLeft, lowerRight))==FAIL ||
 	 GDdefproj(gdIDout, projCode, zoneCode, sphereCode, projParameter) == FAIL ||
-	 GDdeforigin(gdIDout, originCode) == FAIL ||
-	 GDdefcomp(gdIDout, HDFE_COMP_NONE, NULL) == FAIL)
-	{
+	 GDdeforigin(gdIDout, originCode) == FAIL)
+	{
+		if(gdIDout != FAIL)
+			GDdetach(gdIDout);
+		if(fileIDout != FAIL)
+			GDclose(fileIDout);
+		CPLFree(projParameter);
+		GDALClose(dsSource);
 		SetWCS_ErrorLocator("WCS_GetCoverage::CreateHDFEOS2File()");
 		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to create HDF-EOS2 file.");
 		return CE_Failure;
 	}
+	CPLFree(projParameter);
 
+	char fieldDimList[32] = {"YDim,XDim"};
+	CPLErr eErr = CE_None;
+	char* pData = NULL;
 
-	for(int i = 1; i <= bands; i++)
+	for(int i = 1; i <= bands && eErr == CE_None; i++)
 	{
 		string fieldnames = (bands > 1) ? fieldname + convertToString(i) : fieldname ;
 		GDALDataType edt = dsSource->GetRasterBand(i)->GetRasterDataType();
-		int bufSize = x * y * GDALGetDataTypeSize(edt) / 8;;
-		char* pData = (char*) CPLMalloc(bufSize);
-		dsSource->GetRasterBand(i)->RasterIO(GF_Read, 0, 0, x, y, pData, x, y, edt, 0, 0);
-
+		int32 numbertype;
 		switch (edt)
 		{
-		case GDT_Byte:
-		{
-			status = GDdeffield(gdIDout, (char*)fieldnames.c_str(), fieldDimList, DFNT_CHAR, HDFE_NOMERGE);
-			break;
-		}
-		case GDT_UInt16:
-		{
-			status = GDdeffield(gdIDout, (char*)fieldnames.c_str(), fieldDimList, DFNT_UINT16, HDFE_NOMERGE);
-			break;
-		}
-		case GDT_Int16:
-		{
-			status = GDdeffield(gdIDout, (char*)fieldnames.c_str(), fieldDimList, DFNT_INT16, HDFE_NOMERGE);
-			break;
-		}
-		case GDT_UInt32:
-		{
-			status = GDdeffield(gdIDout, (char*)fieldnames.c_str(), fieldDimList, DFNT_UINT32, HDFE_NOMERGE);
-			break;
-		}
-		case GDT_Int32:
-		{
-			status = GDdeffield(gdIDout, (char*)fieldnames.c_str(), fieldDimList, DFNT_INT32, HDFE_NOMERGE);
-			break;
-		}
-		case GDT_Float32:
-		{
-			status = GDdeffield(gdIDout, (char*)fieldnames.c_str(), fieldDimList, DFNT_FLOAT32, HDFE_NOMERGE);
-			break;
-		}
-		case GDT_Float64:
-		{
-			status = GDdeffield(gdIDout, (char*)fieldnames.c_str(), fieldDimList, DFNT_FLOAT64, HDFE_NOMERGE);
-			break;
-		}
+		case GDT_Byte:		numbertype = DFNT_UINT8;	break;
+		case GDT_UInt16:	numbertype = DFNT_UINT16;	break;
+		case GDT_Int16:		numbertype = DFNT_INT16;	break;
+		case GDT_UInt32:	numbertype = DFNT_UINT32;	break;
+		case GDT_Int32:		numbertype = DFNT_INT32;	break;
+		case GDT_Float64:	numbertype = DFNT_FLOAT64;	break;
 		default:
-			status = GDdeffield(gdIDout, (char*)fieldnames.c_str(), fieldDimList, DFNT_INT16, HDFE_NOMERGE);
+			edt = GDT_Float32;
+			numbertype = DFNT_FLOAT32;
 		}
 
-		if(status == FAIL)
+		//The tiling and compression apply to the next defined field
+		if(GDdeftile(gdIDout, HDFE_TILE, 2, tiledims) == FAIL ||
+		   GDdefcomp(gdIDout, compparm[0] > 0 ? HDFE_COMP_DEFLATE : HDFE_COMP_NONE, compparm) == FAIL ||
+		   GDdeffield(gdIDout, (char*)fieldnames.c_str(), fieldDimList, numbertype, HDFE_NOMERGE) == FAIL)
 		{
 			SetWCS_ErrorLocator("WCS_GetCoverage::CreateHDFEOS2File()");
 			WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to attach a field to HDF-EOS2 file.");
-			return CE_Failure;
+			eErr = CE_Failure;
+			break;
 		}
 
-		if(GDwritefield(gdIDout, (char*)fieldnames.c_str(), NULL, NULL, edge, (VOIDP)pData)==FAIL)
+		//The fill value is given in the type of the field
+		double fillvalue[2] = {0, 0};
+		GDALCopyWords(&fill, GDT_Float64, 0, fillvalue, edt, 0, 1);
+		GDsetfillvalue(gdIDout, (char*)fieldnames.c_str(), fillvalue);
+
+		//Stream one row of tiles at a time
+		int nDTSize = GDALGetDataTypeSize(edt) / 8;
+		pData = (char*) CPLRealloc(pData, (size_t)x * tiledims[0] * nDTSize);
+		for(int row = 0; row < y; row += tiledims[0])
 		{
-			SetWCS_ErrorLocator("WCS_GetCoverage::CreateHDFEOS2File()");
-			WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to write the data to HDF-EOS2 file.");
-			return CE_Failure;
+			int rows = MIN(tiledims[0], y - row);
+			int32 start[2] = {row, 0};
+			int32 edge[2] = {rows, x};
+			if(dsSource->GetRasterBand(i)->RasterIO(GF_Read, 0, row, x, rows, pData, x, rows, edt, 0, 0) != CE_None ||
+			   GDwritefield(gdIDout, (char*)fieldnames.c_str(), start, NULL, edge, (VOIDP)pData) == FAIL)
+			{
+				SetWCS_ErrorLocator("WCS_GetCoverage::CreateHDFEOS2File()");
+				WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to write the data to HDF-EOS2 file.");
+				eErr = CE_Failure;
+				break;
+			}
 		}
-		GDsetfillvalue(gdIDout, (char*)fieldnames.c_str(), &fill);
-
-		VSIFree((char*)pData);
 	}
+	CPLFree(pData);
 
-	vector<string> meteList = mp_AbsDS->GetMetaDataList();//Adding the metadata to the output
-	int meteSize = (int)meteList.size();
-	for(int i = 0; i < meteSize; i++)
+	if(eErr == CE_None)
 	{
-		string curname  = meteList.at(i).substr(0, meteList.at(i).find("="));
-		string curvalue = meteList.at(i).substr(meteList.at(i).find("=")+1);
-		if(	!EQUAL(curname.c_str(), "TIFFTAG_XRESOLUTION") &&
-			!EQUAL(curname.c_str(), "TIFFTAG_YRESOLUTION")&&
-			!EQUAL(curname.c_str(), "TIFFTAG_RESOLUTIONUNIT") &&
-			!EQUAL(curname.c_str(), "INPUTPOINTER"))
+		vector<string> meteList = mp_AbsDS->GetMetaDataList();//Adding the metadata to the output
+		int meteSize = (int)meteList.size();
+		for(int i = 0; i < meteSize; i++)
 		{
-			if(EQUAL(curname.c_str(), "EASTBOUNDINGCOORDINATE"))
-				curvalue = convertToString(md_RequestMinX);
-			else if(EQUAL(curname.c_str(), "WESTBOUNDINGCOORDINATE"))
-				curvalue = convertToString(md_RequestMaxX);
-			else if(EQUAL(curname.c_str(), "SOUTHBOUNDINGCOORDINATE"))
-				curvalue = convertToString(md_RequestMinY);
-			else if(EQUAL(curname.c_str(), "NORTHBOUNDINGCOORDINATE"))
-				curvalue = convertToString(md_RequestMaxY);
-
-			GDwriteattr(gdIDout, (char*)curname.c_str(), DFNT_CHAR, curvalue.length(), (VOIDP)curvalue.c_str());
+			string curname  = meteList.at(i).substr(0, meteList.at(i).find("="));
+			string curvalue = meteList.at(i).substr(meteList.at(i).find("=")+1);
+			if(	!EQUAL(curname.c_str(), "TIFFTAG_XRESOLUTION") &&
+				!EQUAL(curname.c_str(), "TIFFTAG_YRESOLUTION")&&
+				!EQUAL(curname.c_str(), "TIFFTAG_RESOLUTIONUNIT") &&
+				!EQUAL(curname.c_str(), "INPUTPOINTER"))
+			{
+				if(EQUAL(curname.c_str(), "EASTBOUNDINGCOORDINATE"))
+					curvalue = convertToString(md_RequestMaxX);
+				else if(EQUAL(curname.c_str(), "WESTBOUNDINGCOORDINATE"))
+					curvalue = convertToString(md_RequestMinX);
+				else if(EQUAL(curname.c_str(), "SOUTHBOUNDINGCOORDINATE"))
+					curvalue = convertToString(md_RequestMinY);
+				else if(EQUAL(curname.c_str(), "NORTHBOUNDINGCOORDINATE"))
+					curvalue = convertToString(md_RequestMaxY);
+
+				GDwriteattr(gdIDout, (char*)curname.c_str(), DFNT_CHAR, curvalue.length(), (VOIDP)curvalue.c_str());
+			}
 		}
+		GDwriteattr(gdIDout, (char*)"EOMetadataContents", DFNT_CHAR, ms_eoMetadataContents.length(), (VOIDP)ms_eoMetadataContents.c_str());
 	}
-	GDwriteattr(gdIDout, (char*)"EOMetadataContents", DFNT_CHAR, ms_eoMetadataContents.length(), (VOIDP)ms_eoMetadataContents.c_str());
 
 	GDdetach(gdIDout);
 	GDclose(fileIDout);
 
 	GDALClose(dsSource);
-	return CE_None;
-*/
-	return CE_None;
+	return eErr;
 }
 
 
@@ -1258,14 +1540,120 @@ CPLErr WCS_GetCoverage::CreateOutputFile(const string& sOutFileName)
 	int bHDF5Data = ms_CovGDALID.find("HDF5") != string::npos ? true : false;
 	int bGOESData = ms_CovGDALID.find("GOES:NETCDF") != string::npos ? true : false;
 	int bNITFData = ms_CovGDALID.find("NITF") != string::npos ? true : false;
-	if(bTRMMData || bHDF5Data || bGOESData) //For TRMM data and OMI data
+
+	//The COG driver is only available from GDAL 3.1, check it before the warp
+	if(EQUAL(ms_OutputFormatCode.c_str(), "COG") && !GDALGetDriverByName("COG"))
 	{
-		tmpcoverageid = sOutFileName + ".tmp.tif";
-		GDALDataset* srcDS = (GDALDataset*)mp_AbsDS->GetGDALDataset();
-		GDALDriverH hOutDriver = GDALGetDriverByName("GTIFF");
-		GDALDatasetH hOutDS = GDALCreateCopy(hOutDriver, tmpcoverageid.c_str(), srcDS, FALSE, NULL, NULL, NULL);
-		GDALClose(srcDS);
-		GDALClose(hOutDS);
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateOutputFile");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "The GDAL driver of the COG output format is not available.");
+		return CE_Failure;
+	}
+
+	//Bound the memory used by the block cache, the output is written tile by tile
+	string sCacheMax = mp_Conf->Get_GDAL_CACHE_MAX();
+	if(!EQUAL(sCacheMax.c_str(), ""))
+		GDALSetCacheMax64((GIntBig)atoi(sCacheMax.c_str()) * 1024 * 1024);
+
+	//Intermediate files are only tiled, compression is applied to the returned file
+	char** papszTiffOptions = GetGTiffCreationOptions();
+	char** papszOutputOptions = GetOutputCreationOptions();
+	string sTiffCmdOptions = GetGTiffCreationCmdOptions();
+
+	//The warp result does not depend on the output format, it is shared by the requests in all formats
+	WCS_Cache oCache(mp_Conf->Get_CACHE_DIRECTORY(), WCS_Cache::GetSizeFromMB(mp_Conf->Get_CACHE_MAX_SIZE(), 1024),
+			WCS_Cache::GetSeconds(mp_Conf->Get_CACHE_LOCK_TIMEOUT(), 300));
+	string sWarpRequest;
+	if(oCache.IsEnabled())
+		sWarpRequest = GetCanonicalWarpRequest();
+	string sCachedWarpFile;
+	int bWarpCached = !sWarpRequest.empty() && oCache.Lookup(sWarpRequest, ".warp.tif", sCachedWarpFile);
+	if(!sWarpRequest.empty() && !bWarpCached)
+	{
+		//Single flight, the lock is held until the warp result is stored, or the warp is computed
+		//without the cache if the request computing it does not finish in time
+		if(CE_None == oCache.Lock(sWarpRequest))
+			bWarpCached = oCache.Lookup(sWarpRequest, ".warp.tif", sCachedWarpFile);
+		else
+			sWarpRequest = "";
+	}
+	bWarpCached = bWarpCached &&
+			CE_None == WCS_Cache::LinkFile(sCachedWarpFile, tmpwarpgeotifffile) &&
+			CE_None == WCS_Cache::LinkFile(sCachedWarpFile, tmptranslategeotifffile);
+	if(!bWarpCached)
+	{
+		//Never write through a link to the cached file
+		unlink(tmpwarpgeotifffile.c_str());
+		unlink(tmptranslategeotifffile.c_str());
+	}
+
+	//Requests in geographic CRS are assembled from the grid-snapped tile cache
+	int bTileGrid = !bWarpCached && IsTileGridRequest();
+
+	//Nearest neighbor requests on swaths are resampled in process, from the scanlines around the request,
+	//or warped by gdalwarp as the other requests if the resampler could not handle the swath, e.g. if its
+	//geolocation is not a regular grid
+	int bSwathNearest = !bWarpCached && !bTileGrid && IsSwathNearestRequest() &&
+			CE_None == CreateSwathNearestWarpFile(tmpwarpgeotifffile, papszTiffOptions);
+
+	//Only the scanlines of the swath around the request are read and rectified, each range from its own source
+	vector<string> vsSwathSources;
+	char** papszGeolocation = mp_AbsDS->GetGDALDataset() ?
+			mp_AbsDS->GetGDALDataset()->GetMetadata("GEOLOCATION") : NULL;
+	int bGeolocationArrays = CSLFetchNameValue(papszGeolocation, "X_DATASET") && CSLFetchNameValue(papszGeolocation, "Y_DATASET");
+	if((IsSwathCoverage() || bGeolocationArrays) && !bWarpCached && !bSwathNearest && !(bTileGrid && IsTileGridCached()))
+	{
+		if(CE_None != CreateSwathRangeSources(sOutFileName, bTileGrid, vsSwathSources))
+		{
+			CSLDestroy(papszTiffOptions);
+			CSLDestroy(papszOutputOptions);
+			return CE_Failure;
+		}
+		for(unsigned int i = 0; i < vsSwathSources.size(); i++)
+			tmpcoverageid = (i == 0 ? vsSwathSources[i] : tmpcoverageid + " " + vsSwathSources[i]);
+	}
+
+	//HDF-EOS5 swaths are warped from the granule with their geolocation arrays as HDF-EOS2 swaths,
+	//if the GDAL driver gives them
+	int bHE5Geolocation = IsSwathCoverage() && ms_CovGDALID.find("EOS_SWATH") == string::npos &&
+			!bWarpCached && !bSwathNearest && (!vsSwathSources.empty() || HasSwathGeolocationArrays());
+
+	vector<string> vsTmpSources;
+	int bWindowSource = false;
+	if((bTRMMData || bHDF5Data || bGOESData) && !bWarpCached && !bSwathNearest && !(bTileGrid && IsTileGridCached()) &&
+		vsSwathSources.empty() && !bHE5Geolocation) //For TRMM data and OMI data
+	{
+		//Only the source blocks around the request (or its tiles) are decoded, and shared with the other requests
+		tmpcoverageid = sOutFileName + ".tmp.vrt";
+		int bDecoded = bTileGrid ?
+				CE_None == CreateDecodedSourceFile(tmpcoverageid, TRUE, -180.0 + mi_TileMinX * md_TileSize,
+						90.0 - (mi_TileMaxY + 1) * md_TileSize, -180.0 + (mi_TileMaxX + 1) * md_TileSize,
+						90.0 - mi_TileMinY * md_TileSize) :
+				CE_None == CreateDecodedSourceFile(tmpcoverageid, mb_SubsetSpatial,
+						md_RequestMinX, md_RequestMinY, md_RequestMaxX, md_RequestMaxY);
+		if(bDecoded)
+			vsTmpSources.push_back(tmpcoverageid);
+		else
+		{
+			//Only the windows around the request are copied, and rectified for GOES
+			bWindowSource = true;
+			CPLErr eWindowErr = bTileGrid ?
+				CreateWindowSourceFile(sOutFileName + ".tmp", TRUE, -180.0 + mi_TileMinX * md_TileSize,
+						90.0 - (mi_TileMaxY + 1) * md_TileSize, -180.0 + (mi_TileMaxX + 1) * md_TileSize,
+						90.0 - mi_TileMinY * md_TileSize, papszTiffOptions, vsTmpSources) :
+				CreateWindowSourceFile(sOutFileName + ".tmp", mb_SubsetSpatial,
+						md_RequestMinX, md_RequestMinY, md_RequestMaxX, md_RequestMaxY, papszTiffOptions, vsTmpSources);
+			if(eWindowErr != CE_None || vsTmpSources.empty())
+			{
+				CSLDestroy(papszTiffOptions);
+				CSLDestroy(papszOutputOptions);
+				return CE_Failure;
+			}
+
+			//The windows on each side of the antimeridian are warped together
+			tmpcoverageid = "";
+			for(unsigned int i = 0; i < vsTmpSources.size(); i++)
+				tmpcoverageid += (i > 0 ? " " : "") + vsTmpSources[i];
+		}
 	}
 
 	if(bNITFData)
@@ -1274,7 +1662,22 @@ CPLErr WCS_GetCoverage::CreateOutputFile(const string& sOutFileName)
 	}
 
 	string m_sWarpCmdPath = mp_Conf->Get_GDAL_WARP_PATH();
-	string m_sWarpCmdContent = m_sWarpCmdPath + " -q -of GTiff";
+	string m_sWarpCmdContent = m_sWarpCmdPath + " -q -of GTiff" + sTiffCmdOptions;
+
+	string sWarpMemory = mp_Conf->Get_WARP_MEMORY_LIMIT();
+	if(!EQUAL(sWarpMemory.c_str(), ""))
+		m_sWarpCmdContent += " -wm " + sWarpMemory;
+	if(!EQUAL(sCacheMax.c_str(), ""))
+		m_sWarpCmdContent += " --config GDAL_CACHEMAX " + sCacheMax;
+
+	//Swath granules are rectified with their full geolocation arrays, through the backward map of the
+	//geolocation transformer, rather than with polynomials fitted to a list of GCPs
+	if(ms_CovGDALID.find("EOS_SWATH") != string::npos || bHE5Geolocation)
+		m_sWarpCmdContent += " --config GEOL_AS_GCPS NONE -geoloc";
+	else if(!vsSwathSources.empty() ||
+			(bGeolocationArrays && !bWindowSource))//the GeoTIFF copies of the windows do not keep the geolocation arrays
+		m_sWarpCmdContent += " -geoloc";
+	string sWarpCmdBase = m_sWarpCmdContent;
 
 	if(ms_ResponseCRS_URN != "")//User specified output CRS
 	{
@@ -1286,6 +1689,8 @@ CPLErr WCS_GetCoverage::CreateOutputFile(const string& sOutFileName)
 			{
 				SetWCS_ErrorLocator( "WCS_GetCoverage::CreateOutputFile()");
 				WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to transform bbox coordinate from request CRS to response CRS.");
+				CSLDestroy(papszTiffOptions);
+				CSLDestroy(papszOutputOptions);
 				return CE_Failure;
 			}
 			md_RequestMinX = llPt.mi_X;
@@ -1299,20 +1704,30 @@ CPLErr WCS_GetCoverage::CreateOutputFile(const string& sOutFileName)
 	else if(ms_RequestCRS_URN != "")
 		m_sWarpCmdContent += " -t_srs " + ms_RequestCRS_URN;
 
+	//Requests crossing the antimeridian are warped in two windows, on each side of it
+	string sSplitWarpCmd = m_sWarpCmdContent;
+	int bSplitIDL = !bWarpCached && !bTileGrid && IsAntimeridianRequest();
+
 	if(mb_SubsetSpatial)
 	{
 		m_sWarpCmdContent += " -te " + convertToString(md_RequestMinX) + " " + convertToString(md_RequestMinY) +
 						" " + convertToString(md_RequestMaxX) + " " + convertToString(md_RequestMaxY);
-		mi_OutputWidth = (int)(md_RequestMaxX - md_RequestMinX)/md_OutGeoTransform[1];
-		mi_OutputHeight = (int)(md_RequestMaxY - md_RequestMinY)/fabs(md_OutGeoTransform[5]);
+		double dfRequestWidth = bSplitIDL && md_RequestMaxX <= md_RequestMinX ?
+				md_RequestMaxX + 360.0 - md_RequestMinX : md_RequestMaxX - md_RequestMinX;
+		mi_OutputWidth = (int)(dfRequestWidth/md_OutGeoTransform[1]);
+		mi_OutputHeight = (int)((md_RequestMaxY - md_RequestMinY)/fabs(md_OutGeoTransform[5]));
+	}
 
-		if(mi_OutputWidth > 10000 || mi_OutputHeight > 10000)
-		{
-			SetWCS_ErrorLocator("WCS_GetCoverage::CreateOutputFile");
-			WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "The extent of the specified bounding box in GetCoverage request is too large. Please check the "
-					"response of DescribeCoverage request for this coverage identifier. ");
-			return CE_Failure;
-		}
+	//The output is streamed into tiled BigTIFF, so its size is only limited by configuration
+	if(IsOutputTooLarge(mvi_OutputWH.empty() ? mi_OutputWidth : mvi_OutputWH.at(0),
+			mvi_OutputWH.empty() ? mi_OutputHeight : mvi_OutputWH.at(1)))
+	{
+		CSLDestroy(papszTiffOptions);
+		CSLDestroy(papszOutputOptions);
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateOutputFile");
+		WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "The extent of the specified bounding box in GetCoverage request is too large. Please check the "
+				"response of DescribeCoverage request for this coverage identifier. ");
+		return CE_Failure;
 	}
 //	if(mb_SubsetSpatial)
 //	{
@@ -1330,27 +1745,81 @@ CPLErr WCS_GetCoverage::CreateOutputFile(const string& sOutFileName)
 	m_sWarpCmdContent += " -r " + ms_Interpolation;
 	m_sWarpCmdContent += " " + tmpcoverageid + " " + tmpwarpgeotifffile;
 
-	if(CE_None != ExeCommand(mp_Conf->Get_WCS_LOGFILE_PATH(), m_sWarpCmdContent))
+	CPLErr eWarpErr = CE_None;
+	if(bTileGrid)
+		eWarpErr = CreateTileGridWarpFile(tmpcoverageid, tmpwarpgeotifffile, sWarpCmdBase, sTiffCmdOptions);
+	else if(bSwathNearest)
+		eWarpErr = CE_None;//already resampled
+	else if(bSplitIDL)
+		eWarpErr = CreateAntimeridianWarpFile(tmpcoverageid, tmpwarpgeotifffile, sSplitWarpCmd, sTiffCmdOptions);
+	else if(!bWarpCached)
+		eWarpErr = ExeCommand(mp_Conf->Get_WCS_LOGFILE_PATH(), m_sWarpCmdContent);
+	for(unsigned int i = 0; i < vsSwathSources.size(); i++)
 	{
+		//with the geolocation arrays of the range
+		unlink(vsSwathSources[i].c_str());
+		unlink((vsSwathSources[i] + ".x.vrt").c_str());
+		unlink((vsSwathSources[i] + ".y.vrt").c_str());
+	}
+	if(mp_BlockCache.get())
+	{
+		//The blocks of this request are still pinned and kept
+		mp_BlockCache->Evict();
+		mp_BlockCache->Unpin();
+	}
+	if(CE_None != eWarpErr)
+	{
+		CSLDestroy(papszTiffOptions);
+		CSLDestroy(papszOutputOptions);
 		SetWCS_ErrorLocator("WCS_GetCoverage::CreateOutputFile");
 		WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "Failed to execute the GDAL command line in the back end.");
 		return CE_Failure;
 	}
 
 	//step 2: Using GDAL translate command line to add new TIFF Tag
-	double dfMin=0.0, dfMax=0.0, dfMean=0.0, dfStdDev=0.0;
-	GDALRasterBandH	hBand = GDALGetRasterBand((GDALDataset*)mp_AbsDS->GetGDALDataset(), 1);
-	GDALGetRasterStatistics( hBand, true, true, &dfMin, &dfMax, &dfMean, &dfStdDev );
-	string m_sTranslateCmdPath = mp_Conf->Get_GDAL_TRANSLATE_PATH();
-	string m_sTranslateCmdContent = m_sTranslateCmdPath + " -q -of GTiff ";
-	m_sTranslateCmdContent += "-mo \"TIFFTAG_SMINSAMPLEVALUE=" + convertToString(dfMin) + "\" -mo \"TIFFTAG_SMAXSAMPLEVALUE=" + convertToString(dfMax) + "\" ";
-	m_sTranslateCmdContent += tmpwarpgeotifffile + " " +  tmptranslategeotifffile;
-	if(CE_None != ExeCommand(mp_Conf->Get_WCS_LOGFILE_PATH(), m_sTranslateCmdContent))
+	if(!bWarpCached)
 	{
-		SetWCS_ErrorLocator("WCS_GetCoverage::CreateOutputFile");
-		WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "Failed to execute the GDAL command line in the back end.");
-		return CE_Failure;
+		double dfMin=0.0, dfMax=0.0, dfMean=0.0, dfStdDev=0.0;
+		if(bGOESData)
+		{
+			//The statistics of GOES are computed on the warp result, reading the source could rectify the whole scan.
+			//PAM is disabled so that no .aux.xml is left next to the warp result.
+			const char* pszOldPam = CPLGetConfigOption("GDAL_PAM_ENABLED", NULL);
+			CPLString osOldPam = pszOldPam ? pszOldPam : "";
+			CPLSetThreadLocalConfigOption("GDAL_PAM_ENABLED", "NO");
+			GDALDatasetH hWarpDS = GDALOpen(tmpwarpgeotifffile.c_str(), GA_ReadOnly);
+			if(hWarpDS)
+			{
+				GDALRasterBandH	hBand = GDALGetRasterBand(hWarpDS, 1);
+				GDALGetRasterStatistics( hBand, true, true, &dfMin, &dfMax, &dfMean, &dfStdDev );
+				GDALClose(hWarpDS);
+			}
+			CPLSetThreadLocalConfigOption("GDAL_PAM_ENABLED", pszOldPam ? osOldPam.c_str() : NULL);
+		}
+		else
+		{
+			GDALRasterBandH	hBand = GDALGetRasterBand((GDALDataset*)mp_AbsDS->GetGDALDataset(), 1);
+			GDALGetRasterStatistics( hBand, true, true, &dfMin, &dfMax, &dfMean, &dfStdDev );
+		}
+		string m_sTranslateCmdPath = mp_Conf->Get_GDAL_TRANSLATE_PATH();
+		string m_sTranslateCmdContent = m_sTranslateCmdPath + " -q -of GTiff" + sTiffCmdOptions + " ";
+		if(!EQUAL(sCacheMax.c_str(), ""))
+			m_sTranslateCmdContent += "--config GDAL_CACHEMAX " + sCacheMax + " ";
+		m_sTranslateCmdContent += "-mo \"TIFFTAG_SMINSAMPLEVALUE=" + convertToString(dfMin) + "\" -mo \"TIFFTAG_SMAXSAMPLEVALUE=" + convertToString(dfMax) + "\" ";
+		m_sTranslateCmdContent += tmpwarpgeotifffile + " " +  tmptranslategeotifffile;
+		if(CE_None != ExeCommand(mp_Conf->Get_WCS_LOGFILE_PATH(), m_sTranslateCmdContent))
+		{
+			CSLDestroy(papszTiffOptions);
+			CSLDestroy(papszOutputOptions);
+			SetWCS_ErrorLocator("WCS_GetCoverage::CreateOutputFile");
+			WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "Failed to execute the GDAL command line in the back end.");
+			return CE_Failure;
+		}
+
+		if(!sWarpRequest.empty())
+			oCache.Store(sWarpRequest, ".warp.tif", tmptranslategeotifffile);
 	}
+	oCache.Unlock();
 
 	//Yuanzheng Shao, need to write the metadata to file in GeoTIFF ?
 	CreateEOMetadata(tmpwarpgeotifffile);
@@ -1362,13 +1831,28 @@ CPLErr WCS_GetCoverage::CreateOutputFile(const string& sOutFileName)
 		if(CE_None == CreateHDFEOS2File(tmptranslategeotifffile, sOutFileName))
 		{
 			unlink(tmpwarpgeotifffile.c_str());
+			CSLDestroy(papszTiffOptions);
+			CSLDestroy(papszOutputOptions);
 			return CE_None;
 		}
 		else
 		{
+			CSLDestroy(papszTiffOptions);
+			CSLDestroy(papszOutputOptions);
 			return CE_Failure;
 		}
 	}
+	else if(EQUAL(ms_OutputFormatCode.c_str(), "BINARY"))
+	{
+		CPLErr eErr = CreateBinaryFile(tmptranslategeotifffile, sOutFileName);
+		for(unsigned int i = 0; i < vsTmpSources.size(); i++)
+			unlink(vsTmpSources[i].c_str());
+		unlink(tmpwarpgeotifffile.c_str());
+		unlink(tmptranslategeotifffile.c_str());
+		CSLDestroy(papszTiffOptions);
+		CSLDestroy(papszOutputOptions);
+		return eErr;
+	}
 	//In order to support JPIP protocol
 	//Use gdal and Kakadu to process NITF data, and generate a JPIP URL by delivering with ESA JPIP server
 	else if (EQUAL(ms_OutputFormatCode.c_str(), "JPIP"))
@@ -1387,6 +1871,8 @@ CPLErr WCS_GetCoverage::CreateOutputFile(const string& sOutFileName)
 		{
 			SetWCS_ErrorLocator("WCS_GetCoverage::CreateOutputFile");
 			WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "Failed to execute the Kakadu command line in the back end.");
+			CSLDestroy(papszTiffOptions);
+			CSLDestroy(papszOutputOptions);
 			return CE_Failure;
 		}
 
@@ -1395,28 +1881,8 @@ CPLErr WCS_GetCoverage::CreateOutputFile(const string& sOutFileName)
 		{
 			SetWCS_ErrorLocator("WCS_GetCoverage::CreateOutputFile");
 			WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "Failed to move jp2 file to JPIP folder.");
-			return CE_Failure;
-		}
-	}
-	//In order to support GMLJP2
-	//JPEG2000 as output format code in GDAL. But in fact, kdu_compress command was used to convert GeoTIFF
-	//to JPEG2000, which could be served with ESA JPIP server.
-	else if(EQUAL(ms_OutputFormatCode.c_str(), "JPEG2000"))
-	{
-		WCS_DescribeCoverage* dc = new WCS_DescribeCoverage();
-		string describeCoverageResponse =  dc->CreateDescibeCoverageXMLByCoverageID(ms_CovGDALID);
-		string gmljp2Metadata = doPostFromString("http://129.174.131.8:9003/ows9_ic/gmljp2Converter?", describeCoverageResponse);
-		ofstream gmljp2boxfile(tmpgmljp2box.c_str());
-		gmljp2boxfile<<"xml "<<gmljp2Metadata;//ms_eoMetadataContents;
-		ms_eoMetadataContents = gmljp2Metadata;
-
-		string m_sKduCompressCmdPath = mp_Conf->Get_KAKADU_COMPRESS_PATH();
-		string m_skduCompressCmdContent = m_sKduCompressCmdPath + " -i " + tmptranslategeotifffile;
-		m_skduCompressCmdContent += " -o " + sOutFileName + " -jp2_box " + tmpgmljp2box + " ORGgen_plt=yes Creversible=yes";
-		if(CE_None != ExeCommand(mp_Conf->Get_WCS_LOGFILE_PATH(), m_skduCompressCmdContent))
-		{
-			SetWCS_ErrorLocator("WCS_GetCoverage::CreateOutputFile");
-			WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "Failed to execute the Kakadu command line in the back end.");
+			CSLDestroy(papszTiffOptions);
+			CSLDestroy(papszOutputOptions);
 			return CE_Failure;
 		}
 	}
@@ -1452,30 +1918,1769 @@ CPLErr WCS_GetCoverage::CreateOutputFile(const string& sOutFileName)
 		}
 		warpDS->SetMetadataItem("EOMetadataContents", ms_eoMetadataContents.c_str(), "");
 
-		GDALDriverH hReturnDriver = GDALGetDriverByName(ms_OutputFormatCode.c_str());//temporary method for TRMM data
-		GDALDatasetH hReturnDS = GDALCreateCopy(hReturnDriver, sOutFileName.c_str(), warpDS, FALSE, NULL, NULL, NULL);
+		//JPEG2000 is encoded in process with OpenJPEG, GMLJP2 boxes are built by the driver
+		//from the geotransform and CRS of the warp result, and the tiles are encoded in parallel
+		int bJPEG2000 = EQUAL(ms_OutputFormatCode.c_str(), "JPEG2000");
+		GDALDriverH hReturnDriver = GDALGetDriverByName(bJPEG2000 ? "JP2OpenJPEG" : ms_OutputFormatCode.c_str());//temporary method for TRMM data
+		if(!hReturnDriver)
+		{
+			GDALClose(warpDS);
+			SetWCS_ErrorLocator("WCS_GetCoverage::CreateOutputFile");
+			WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "The GDAL driver of the output format is not available.");
+			CSLDestroy(papszTiffOptions);
+			CSLDestroy(papszOutputOptions);
+			return CE_Failure;
+		}
+
+		string sThreads = mp_Conf->Get_COMPRESSION_THREADS();
+		if(bJPEG2000)
+			CPLSetThreadLocalConfigOption("GDAL_NUM_THREADS", EQUAL(sThreads.c_str(), "") ? "ALL_CPUS" : sThreads.c_str());
+		GDALDatasetH hReturnDS = GDALCreateCopy(hReturnDriver, sOutFileName.c_str(), warpDS, FALSE,
+				papszOutputOptions, NULL, NULL);
+		if(bJPEG2000)
+			CPLSetThreadLocalConfigOption("GDAL_NUM_THREADS", NULL);
 		GDALClose(warpDS);
+		if(!hReturnDS)
+		{
+			SetWCS_ErrorLocator("WCS_GetCoverage::CreateOutputFile");
+			WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to create the output file.");
+			CSLDestroy(papszTiffOptions);
+			CSLDestroy(papszOutputOptions);
+			return CE_Failure;
+		}
 		GDALClose(hReturnDS);
 
 		//step 4, delete temporary files
-		if(bTRMMData || bHDF5Data)
-			unlink(tmpcoverageid.c_str());
+		for(unsigned int i = 0; i < vsTmpSources.size(); i++)
+			unlink(vsTmpSources[i].c_str());
 		unlink(tmpwarpgeotifffile.c_str());
 		unlink(tmptranslategeotifffile.c_str());
 
 	}
 
+	CSLDestroy(papszTiffOptions);
+	CSLDestroy(papszOutputOptions);
+
 	return CE_None;
 }
 
 /************************************************************************/
-/*                           WCST_Respond()                             */
+/*                       GetGTiffCreationOptions()                      */
 /************************************************************************/
 
 /**
- * \brief The enter point for WCS_GetCoverage class (Command line environment).
+ * \brief Fetch the creation options for GeoTIFF files.
  *
- * This method is the enter point for WCS_GetCoverage class, which
+ * This method is used to build the creation options for the intermediate
+ * and output GeoTIFF files. The files are tiled, so that gdalwarp and
+ * gdal_translate could write them block by block with bounded memory, and
+ * BigTIFF is used when the output may exceed 4GB.
+ *
+ * When compression is requested, the method comes from the
+ * "geotiff:compression" parameter or the configured default, and the
+ * predictor is chosen by the data type of the coverage: floating point
+ * predictor for float data, horizontal differencing for integer data.
+ * The tiles are compressed by several threads in parallel.
+ *
+ * @param bCompress Whether to add the compression options, which is only
+ * worth for the returned file, not for the intermediate files.
+ *
+ * @return The creation options list, which should be freed with CSLDestroy().
+ */
+
+char** WCS_GetCoverage::GetGTiffCreationOptions(int bCompress)
+{
+	char** papszOptions = NULL;
+	papszOptions = CSLSetNameValue(papszOptions, "TILED", "YES");
+	papszOptions = CSLSetNameValue(papszOptions, "BIGTIFF", "IF_SAFER");
+
+	string sTileSize = mp_Conf->Get_OUTPUT_TILE_SIZE();
+	if(!EQUAL(sTileSize.c_str(), ""))
+	{
+		papszOptions = CSLSetNameValue(papszOptions, "BLOCKXSIZE", sTileSize.c_str());
+		papszOptions = CSLSetNameValue(papszOptions, "BLOCKYSIZE", sTileSize.c_str());
+	}
+
+	if(!bCompress)
+		return papszOptions;
+
+	string sCompress = ms_Compression;
+	if(EQUAL(sCompress.c_str(), ""))
+		sCompress = CPLString(mp_Conf->Get_OUTPUT_COMPRESSION()).toupper();
+	if(EQUAL(sCompress.c_str(), ""))
+		sCompress = "DEFLATE";
+	if(EQUAL(sCompress.c_str(), "NONE"))
+		return papszOptions;
+
+	papszOptions = CSLSetNameValue(papszOptions, "COMPRESS", sCompress.c_str());
+
+	if(EQUAL(sCompress.c_str(), "DEFLATE") || EQUAL(sCompress.c_str(), "ZSTD") || EQUAL(sCompress.c_str(), "LZW"))
+	{
+		string sPredictor = ms_Predictor;
+		GDALDataset* poDS = mp_AbsDS.get() ? mp_AbsDS->GetGDALDataset() : NULL;
+		if(EQUAL(sPredictor.c_str(), "") && poDS && poDS->GetRasterCount() > 0)
+		{
+			GDALDataType eDataType = poDS->GetRasterBand(1)->GetRasterDataType();
+			if(eDataType == GDT_Float32 || eDataType == GDT_Float64)
+				sPredictor = "3";
+			else if(eDataType != GDT_Byte && !GDALDataTypeIsComplex(eDataType))
+				sPredictor = "2";
+		}
+		if(!EQUAL(sPredictor.c_str(), ""))
+			papszOptions = CSLSetNameValue(papszOptions, "PREDICTOR", sPredictor.c_str());
+	}
+
+	string sLevel = ms_CompressionLevel;
+	if(EQUAL(sLevel.c_str(), ""))
+		sLevel = mp_Conf->Get_OUTPUT_COMPRESSION_LEVEL();
+	if(!EQUAL(sLevel.c_str(), ""))
+	{
+		int nLevel = atoi(sLevel.c_str());
+		if(EQUAL(sCompress.c_str(), "DEFLATE"))
+		{
+			nLevel = MIN(nLevel, 9);
+			papszOptions = CSLSetNameValue(papszOptions, "ZLEVEL", convertToString(nLevel).c_str());
+		}
+		else if(EQUAL(sCompress.c_str(), "ZSTD"))
+			papszOptions = CSLSetNameValue(papszOptions, "ZSTD_LEVEL", convertToString(nLevel).c_str());
+	}
+
+	string sThreads = mp_Conf->Get_COMPRESSION_THREADS();
+	papszOptions = CSLSetNameValue(papszOptions, "NUM_THREADS",
+			EQUAL(sThreads.c_str(), "") ? "ALL_CPUS" : sThreads.c_str());
+
+	return papszOptions;
+}
+
+/************************************************************************/
+/*                     GetGTiffCreationCmdOptions()                     */
+/************************************************************************/
+
+/**
+ * \brief Fetch the creation options for GeoTIFF files as command line options.
+ *
+ * This method is used to convert the GeoTIFF creation options to the
+ * "-co" options of gdalwarp and gdal_translate command line.
+ *
+ * @return The command line options string, begins with a space.
+ */
+
+string WCS_GetCoverage::GetGTiffCreationCmdOptions()
+{
+	char** papszOptions = GetGTiffCreationOptions();
+	string sCmdOptions;
+	for(int i = 0; i < CSLCount(papszOptions); i++)
+		sCmdOptions += string(" -co ") + papszOptions[i];
+	CSLDestroy(papszOptions);
+
+	return sCmdOptions;
+}
+
+/************************************************************************/
+/*                        GetCOGCreationOptions()                       */
+/************************************************************************/
+
+/**
+ * \brief Fetch the creation options for Cloud-Optimized GeoTIFF files.
+ *
+ * This method is used to build the creation options of the GDAL COG driver
+ * from the GeoTIFF compression options. The driver writes the tiles, the
+ * internal overviews and the IFDs at the beginning of the file in one
+ * pass, so that clients could read any window or resolution with HTTP
+ * range requests. The overviews are computed with the interpolation of
+ * the request, by the same threads which compress the tiles.
+ *
+ * @return The creation options list, which should be freed with CSLDestroy().
+ */
+
+char** WCS_GetCoverage::GetCOGCreationOptions()
+{
+	char** papszTiffOptions = GetGTiffCreationOptions(TRUE);
+	char** papszOptions = NULL;
+
+	papszOptions = CSLSetNameValue(papszOptions, "BIGTIFF", "IF_SAFER");
+
+	string sBlockSize = mp_Conf->Get_COG_BLOCK_SIZE();
+	if(EQUAL(sBlockSize.c_str(), ""))
+		sBlockSize = mp_Conf->Get_OUTPUT_TILE_SIZE();
+	if(EQUAL(sBlockSize.c_str(), ""))
+		sBlockSize = "512";
+	papszOptions = CSLSetNameValue(papszOptions, "BLOCKSIZE", sBlockSize.c_str());
+
+	const char* pszCompress = CSLFetchNameValue(papszTiffOptions, "COMPRESS");
+	papszOptions = CSLSetNameValue(papszOptions, "COMPRESS", pszCompress ? pszCompress : "NONE");
+
+	const char* pszPredictor = CSLFetchNameValue(papszTiffOptions, "PREDICTOR");
+	if(pszPredictor)
+		papszOptions = CSLSetNameValue(papszOptions, "PREDICTOR",
+				EQUAL(pszPredictor, "3") ? "FLOATING_POINT" : (EQUAL(pszPredictor, "2") ? "STANDARD" : "NO"));
+
+	const char* pszLevel = CSLFetchNameValue(papszTiffOptions, "ZLEVEL");
+	if(!pszLevel)
+		pszLevel = CSLFetchNameValue(papszTiffOptions, "ZSTD_LEVEL");
+	if(pszLevel)
+		papszOptions = CSLSetNameValue(papszOptions, "LEVEL", pszLevel);
+
+	string sThreads = mp_Conf->Get_COMPRESSION_THREADS();
+	papszOptions = CSLSetNameValue(papszOptions, "NUM_THREADS",
+			EQUAL(sThreads.c_str(), "") ? "ALL_CPUS" : sThreads.c_str());
+
+	papszOptions = CSLSetNameValue(papszOptions, "OVERVIEWS", "AUTO");
+	papszOptions = CSLSetNameValue(papszOptions, "OVERVIEW_RESAMPLING",
+			EQUAL(ms_Interpolation.c_str(), "near") ? "NEAREST" : CPLString(ms_Interpolation).toupper().c_str());
+
+	CSLDestroy(papszTiffOptions);
+
+	return papszOptions;
+}
+
+/************************************************************************/
+/*                       GetJP2CreationOptions()                        */
+/************************************************************************/
+
+/**
+ * \brief Fetch the creation options for JPEG2000 files.
+ *
+ * This method is used to build the creation options of the JP2OpenJPEG
+ * driver. GMLJP2 and GeoJP2 boxes are embedded, the image is cut into
+ * tiles of OUTPUT_TILE_SIZE (1024 by default), and the quality layers come
+ * from JPEG2000_QUALITY, a comma separated list of the percentages of the
+ * uncompressed size. Without quality layers the image is encoded reversibly.
+ *
+ * @return The creation options list, which should be freed with CSLDestroy().
+ */
+
+char** WCS_GetCoverage::GetJP2CreationOptions()
+{
+	char** papszOptions = NULL;
+	papszOptions = CSLSetNameValue(papszOptions, "CODEC", "JP2");
+	papszOptions = CSLSetNameValue(papszOptions, "GMLJP2", "YES");
+	papszOptions = CSLSetNameValue(papszOptions, "GeoJP2", "YES");
+
+	string sTileSize = mp_Conf->Get_OUTPUT_TILE_SIZE();
+	if(EQUAL(sTileSize.c_str(), ""))
+		sTileSize = "1024";
+	papszOptions = CSLSetNameValue(papszOptions, "BLOCKXSIZE", sTileSize.c_str());
+	papszOptions = CSLSetNameValue(papszOptions, "BLOCKYSIZE", sTileSize.c_str());
+
+	string sQuality = mp_Conf->Get_JPEG2000_QUALITY();
+	if(EQUAL(sQuality.c_str(), ""))
+	{
+		papszOptions = CSLSetNameValue(papszOptions, "QUALITY", "100");
+		papszOptions = CSLSetNameValue(papszOptions, "REVERSIBLE", "YES");
+	}
+	else
+	{
+		papszOptions = CSLSetNameValue(papszOptions, "QUALITY", sQuality.c_str());
+		papszOptions = CSLSetNameValue(papszOptions, "PROGRESSION", "LRCP");
+	}
+
+	return papszOptions;
+}
+
+/************************************************************************/
+/*                      GetOutputCreationOptions()                      */
+/************************************************************************/
+
+/**
+ * \brief Fetch the creation options for the returned file.
+ *
+ * @return The creation options list of the output format, or NULL if the
+ * format has no options. It should be freed with CSLDestroy().
+ */
+
+char** WCS_GetCoverage::GetOutputCreationOptions()
+{
+	if(EQUAL(ms_OutputFormatCode.c_str(), "COG"))
+		return GetCOGCreationOptions();
+	else if(EQUAL(ms_OutputFormatCode.c_str(), "GTIFF"))
+		return GetGTiffCreationOptions(TRUE);
+	else if(EQUAL(ms_OutputFormatCode.c_str(), "JPEG2000"))
+		return GetJP2CreationOptions();
+
+	return NULL;
+}
+
+/************************************************************************/
+/*                         GetCanonicalRequest()                        */
+/************************************************************************/
+
+/**
+ * \brief Fetch the canonical form of the GetCoverage request.
+ *
+ * This method is used to build the key of the result cache. The canonical
+ * request is made of the canonical warp request, the format and the
+ * creation options of the output, so that it changes whenever the output
+ * would change.
+ *
+ * @return The canonical request, or empty string if the source file could
+ * not be identified and the output should not be cached.
+ */
+
+string WCS_GetCoverage::GetCanonicalRequest()
+{
+	string sCanonical = GetCanonicalWarpRequest();
+	if (EQUAL(sCanonical.c_str(), ""))
+		return "";
+
+	sCanonical += "format=" + ms_OutputFormatCode + "\n";
+
+	char** papszOptions = GetOutputCreationOptions();
+	for (int i = 0; i < CSLCount(papszOptions); i++)
+		sCanonical += string("option=") + papszOptions[i] + "\n";
+	CSLDestroy(papszOptions);
+
+	return sCanonical;
+}
+
+/************************************************************************/
+/*                       GetCanonicalWarpRequest()                      */
+/************************************************************************/
+
+/**
+ * \brief Fetch the canonical form of the GetCoverage request except format.
+ *
+ * This method is used to build the key of the warp result, which is shared
+ * by the requests of the same subset in all the output formats. It is made
+ * of the coverage identifier, the identity (path, size and modification
+ * time) of the source file, the normalized subset, CRS, size or resolution,
+ * interpolation and bands.
+ *
+ * @return The canonical warp request, or empty string if the source file
+ * could not be identified.
+ */
+
+string WCS_GetCoverage::GetCanonicalWarpRequest()
+{
+	string sSource = GetSourceIdentity();
+	if (EQUAL(sSource.c_str(), ""))
+		return "";
+
+	string sCanonical;
+	sCanonical += "coverage=" + ms_CovGDALID + "\n";
+	sCanonical += "source=" + sSource + "\n";
+
+	if (mb_SubsetSpatial)
+		sCanonical += CPLString().Printf("bbox=%.12g,%.12g,%.12g,%.12g\n",
+				md_RequestMinX, md_RequestMinY, md_RequestMaxX, md_RequestMaxY);
+	sCanonical += "time=" + ms_RequestBeginTime + "," + ms_RequestEndTime + "\n";
+
+	char* pszWKT = NULL;
+	mo_RequestedCRS.exportToWkt(&pszWKT);
+	sCanonical += string("subsetcrs=") + (pszWKT ? pszWKT : "") + "\n";
+	OGRFree(pszWKT);
+	pszWKT = NULL;
+	mo_ResponseCRS.exportToWkt(&pszWKT);
+	sCanonical += string("outputcrs=") + (pszWKT ? pszWKT : "") + "\n";
+	OGRFree(pszWKT);
+
+	sCanonical += "size=";
+	for (size_t i = 0; i < mvi_OutputWH.size(); i++)
+		sCanonical += convertToString(mvi_OutputWH[i]) + ",";
+	sCanonical += "\nresolution=";
+	for (size_t i = 0; i < mvd_OutputResXY.size(); i++)
+		sCanonical += CPLString().Printf("%.12g,", mvd_OutputResXY[i]);
+	sCanonical += "\ninterpolation=" + ms_Interpolation + "\nbands=";
+	for (size_t i = 0; i < mvi_BandList.size(); i++)
+		sCanonical += convertToString(mvi_BandList[i]) + ",";
+	sCanonical += "\n";
+
+	sCanonical += "tilegrid=" + mp_Conf->Get_TILE_CACHE_DIRECTORY() + "," + mp_Conf->Get_TILE_GRID_SIZE() + "\n";
+
+	return sCanonical;
+}
+
+/************************************************************************/
+/*                          GetSourceIdentity()                         */
+/************************************************************************/
+
+/**
+ * \brief Fetch the identity of the source file of the coverage.
+ *
+ * @return The path, size and modification time of the source file, or
+ * empty string if the source file could not be found.
+ */
+
+string WCS_GetCoverage::GetSourceIdentity()
+{
+	string sSrcFileName = mp_AbsDS->GetResourceFileName();
+	VSIStatBufL sStat;
+	if (EQUAL(sSrcFileName.c_str(), "") || VSIStatL(sSrcFileName.c_str(), &sStat) != 0)
+		return "";
+
+	return CPLString().Printf("%s," CPL_FRMT_GIB ",%ld", sSrcFileName.c_str(),
+			(GIntBig)sStat.st_size, (long)sStat.st_mtime);
+}
+
+/************************************************************************/
+/*                            IsGeographicCRS()                         */
+/************************************************************************/
+
+/**
+ * \brief Whether a CRS of the request is geographic.
+ *
+ * This method is used to avoid computing IsGeographic() again for the
+ * request and response CRS, whose flag is computed once when the CRS is
+ * parsed into the CRS registry.
+ *
+ * @param poRegCRS The registered CRS, NULL if the CRS is not from the registry.
+ *
+ * @param oCRS The CRS, tested when it is not from the registry.
+ *
+ * @return TRUE if the CRS is geographic, FALSE otherwise.
+ */
+
+int WCS_GetCoverage::IsGeographicCRS(const RegisteredCRS* poRegCRS, const OGRSpatialReference& oCRS)
+{
+	return poRegCRS ? poRegCRS->mb_Geographic : oCRS.IsGeographic();
+}
+
+/************************************************************************/
+/*                          IsTileGridRequest()                         */
+/************************************************************************/
+
+/**
+ * \brief Whether the request could be assembled from the tile cache.
+ *
+ * This method is used to check whether the tile cache is configured and the
+ * request subsets the coverage in the geographic CRS of the output, and to
+ * set up the tile grid of the coverage. The grid starts from (-180, 90)
+ * with TILE_GRID_SIZE degrees tiles, the pixels of a tile are derived from
+ * the native resolution of the coverage, so that the tiles are shared by
+ * all the requests of the coverage with the same interpolation and bands.
+ *
+ * @return TRUE if the request should be assembled from tiles, FALSE otherwise.
+ */
+
+int WCS_GetCoverage::IsTileGridRequest()
+{
+	ms_TileGridKey = "";
+	if (EQUAL(mp_Conf->Get_TILE_CACHE_DIRECTORY().c_str(), "") || !mb_SubsetSpatial)
+		return FALSE;
+
+	//The bounding box must be in the CRS of the output, which is geographic
+	const OGRSpatialReference* poTileCRS = &mp_AbsDS->GetNativeCRS();
+	const RegisteredCRS* poTileRegCRS = NULL;
+	ms_TileCRS_URN = "";
+	if (ms_ResponseCRS_URN != "")
+	{
+		if (!mo_RequestedCRS.IsSame(&mo_ResponseCRS))
+			return FALSE;
+		poTileCRS = &mo_ResponseCRS;
+		poTileRegCRS = mp_ResponseRegCRS;
+		ms_TileCRS_URN = ms_ResponseCRS_URN;
+	}
+	else if (ms_RequestCRS_URN != "")
+	{
+		poTileCRS = &mo_RequestedCRS;
+		poTileRegCRS = mp_RequestedRegCRS;
+		ms_TileCRS_URN = ms_RequestCRS_URN;
+	}
+	if (!IsGeographicCRS(poTileRegCRS, *poTileCRS) || md_RequestMinX > md_RequestMaxX || md_RequestMaxX > 180.0)
+		return FALSE;
+
+	string sSource = GetSourceIdentity();
+	double adfGeoMinMax[4];
+	if (EQUAL(sSource.c_str(), "") || mp_AbsDS->GetImageXSize() <= 0 ||
+		CE_None != mp_AbsDS->GetGeoMinMax(adfGeoMinMax))
+		return FALSE;
+
+	string sTileSize = mp_Conf->Get_TILE_GRID_SIZE();
+	md_TileSize = EQUAL(sTileSize.c_str(), "") ? 1.0 : atof(sTileSize.c_str());
+	double dfNativeRes = (adfGeoMinMax[1] - adfGeoMinMax[0]) / mp_AbsDS->GetImageXSize();
+	if (md_TileSize <= 0 || dfNativeRes <= 0)
+		return FALSE;
+	mi_TilePixels = MAX(1, MIN(4096, (int)ceil(md_TileSize / dfNativeRes)));
+
+	mi_TileMinX = (int)floor((md_RequestMinX + 180.0) / md_TileSize);
+	mi_TileMaxX = (int)ceil((md_RequestMaxX + 180.0) / md_TileSize) - 1;
+	mi_TileMinY = (int)floor((90.0 - md_RequestMaxY) / md_TileSize);
+	mi_TileMaxY = (int)ceil((90.0 - md_RequestMinY) / md_TileSize) - 1;
+	mi_TileMaxX = MAX(mi_TileMinX, mi_TileMaxX);
+	mi_TileMaxY = MAX(mi_TileMinY, mi_TileMaxY);
+
+	//Large extents are warped directly rather than tile by tile
+	if ((double)(mi_TileMaxX - mi_TileMinX + 1) * (mi_TileMaxY - mi_TileMinY + 1) > 256)
+		return FALSE;
+
+	char* pszWKT = NULL;
+	poTileCRS->exportToWkt(&pszWKT);
+	string sGrid = "coverage=" + ms_CovGDALID + "\nsource=" + sSource + "\ncrs=" + (pszWKT ? pszWKT : "");
+	OGRFree(pszWKT);
+	sGrid += CPLString().Printf("\ngrid=%.12g,%d\ninterpolation=", md_TileSize, mi_TilePixels);
+	sGrid += ms_Interpolation + "\nbands=";
+	for (size_t i = 0; i < mvi_BandList.size(); i++)
+		sGrid += convertToString(mvi_BandList[i]) + ",";
+	ms_TileGridKey = GetStringHash(sGrid);
+	mp_TileCache.reset(new WCS_Cache(mp_Conf->Get_TILE_CACHE_DIRECTORY(),
+			WCS_Cache::GetSizeFromMB(mp_Conf->Get_TILE_CACHE_MAX_SIZE(), 4096)));
+
+	return TRUE;
+}
+
+/************************************************************************/
+/*                           GetTileFileName()                          */
+/************************************************************************/
+
+string WCS_GetCoverage::GetTileFileName(int nTileX, int nTileY)
+{
+	string sTileName = ms_TileGridKey + "_" + convertToString(nTileX) + "_" + convertToString(nTileY) + ".tif";
+	return CPLFormFilename(mp_Conf->Get_TILE_CACHE_DIRECTORY().c_str(), sTileName.c_str(), NULL);
+}
+
+/************************************************************************/
+/*                           IsTileGridCached()                         */
+/************************************************************************/
+
+/**
+ * \brief Whether all the tiles intersecting the request are cached.
+ *
+ * The cached tiles are pinned, so that they are not evicted by the
+ * concurrent requests before they are cut by CreateTileGridWarpFile().
+ *
+ * @return TRUE if all the tiles are cached, FALSE otherwise.
+ */
+
+int WCS_GetCoverage::IsTileGridCached()
+{
+	for (int iy = mi_TileMinY; iy <= mi_TileMaxY; iy++)
+		for (int ix = mi_TileMinX; ix <= mi_TileMaxX; ix++)
+			if (!mp_TileCache->Pin(GetTileFileName(ix, iy)))
+				return FALSE;
+
+	return TRUE;
+}
+
+/************************************************************************/
+/*                        CreateTileGridWarpFile()                      */
+/************************************************************************/
+
+/**
+ * \brief Create the warp result of the request from the tile cache.
+ *
+ * This method is used to create the warp result by mosaicking the cached
+ * tiles. The missing tiles are warped from the source and added to the
+ * cache, then the tiles are mosaicked with a VRT dataset, and the request
+ * is cut out of the mosaic by a window operation of gdal_translate, which
+ * only reads the blocks of the tiles inside the bounding box. The tiles are
+ * pinned until they are cut, the concurrent requests only evict the tiles
+ * which are not in use.
+ *
+ * @param sSrcName The coverage identifier or file passed to gdalwarp.
+ *
+ * @param sWarpFileName The path of the warp result.
+ *
+ * @param sWarpCmdBase The gdalwarp command line with the common options.
+ *
+ * @param sTiffCmdOptions The GeoTIFF creation options of gdal_translate.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr WCS_GetCoverage::CreateTileGridWarpFile(const string& sSrcName, const string& sWarpFileName,
+		const string& sWarpCmdBase, const string& sTiffCmdOptions)
+{
+	string sTileDir = mp_Conf->Get_TILE_CACHE_DIRECTORY();
+	VSIStatBufL sStat;
+	if (VSIStatL(sTileDir.c_str(), &sStat) != 0)
+		VSIMkdir(sTileDir.c_str(), 0755);
+
+	//step 1: warp the missing tiles, the tiles are renamed into the cache when complete
+	double dfPixelSize = md_TileSize / mi_TilePixels;
+	int nPid = (int)getpid();
+	for (int iy = mi_TileMinY; iy <= mi_TileMaxY; iy++)
+	{
+		for (int ix = mi_TileMinX; ix <= mi_TileMaxX; ix++)
+		{
+			string sTileFileName = GetTileFileName(ix, iy);
+			if (mp_TileCache->Pin(sTileFileName))
+			{
+				utime(sTileFileName.c_str(), NULL);
+				continue;
+			}
+
+			string sTmpTileFileName = sTileFileName + "." + convertToString(nPid) + ".tmp";
+			string sWarpCmd = sWarpCmdBase;
+			if (ms_TileCRS_URN != "")
+				sWarpCmd += " -t_srs " + ms_TileCRS_URN;
+			sWarpCmd += CPLString().Printf(" -te %.12g %.12g %.12g %.12g -ts %d %d",
+					-180.0 + ix * md_TileSize, 90.0 - (iy + 1) * md_TileSize,
+					-180.0 + (ix + 1) * md_TileSize, 90.0 - iy * md_TileSize, mi_TilePixels, mi_TilePixels);
+			sWarpCmd += " -dstnodata " + convertToString(mp_AbsDS->GetMissingValue());
+			sWarpCmd += " -r " + ms_Interpolation;
+			sWarpCmd += " " + sSrcName + " " + sTmpTileFileName;
+
+			if (CE_None != ExeCommand(mp_Conf->Get_WCS_LOGFILE_PATH(), sWarpCmd) ||
+				!mp_TileCache->Pin(sTmpTileFileName) ||
+				rename(sTmpTileFileName.c_str(), sTileFileName.c_str()) != 0)
+			{
+				unlink(sTmpTileFileName.c_str());
+				SetWCS_ErrorLocator("WCS_GetCoverage::CreateTileGridWarpFile()");
+				WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to warp the tile of coverage.");
+				return CE_Failure;
+			}
+		}
+	}
+
+	//step 2: mosaic the tiles with a VRT dataset
+	GDALDataset* poTileDS = (GDALDataset*) GDALOpen(GetTileFileName(mi_TileMinX, mi_TileMinY).c_str(), GA_ReadOnly);
+	if (!poTileDS || poTileDS->GetRasterCount() < 1)
+	{
+		if (poTileDS)
+			GDALClose(poTileDS);
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateTileGridWarpFile()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to open the tile of coverage.");
+		return CE_Failure;
+	}
+	int nBands = poTileDS->GetRasterCount();
+	GDALDataType eDataType = poTileDS->GetRasterBand(1)->GetRasterDataType();
+	string sTileWKT = poTileDS->GetProjectionRef();
+	GDALClose(poTileDS);
+
+	string sVRTFileName = sWarpFileName + ".vrt";
+	int nMosaicXSize = (mi_TileMaxX - mi_TileMinX + 1) * mi_TilePixels;
+	int nMosaicYSize = (mi_TileMaxY - mi_TileMinY + 1) * mi_TilePixels;
+	GDALDriver* poVRTDriver = (GDALDriver*) GDALGetDriverByName("VRT");
+	VRTDataset* poVDS = poVRTDriver ?
+			(VRTDataset*) poVRTDriver->Create(sVRTFileName.c_str(), nMosaicXSize, nMosaicYSize, 0, eDataType, NULL) : NULL;
+	if (!poVDS)
+	{
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateTileGridWarpFile()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to create VRT DataSet.");
+		return CE_Failure;
+	}
+
+	double adfGeoTransform[6] = {-180.0 + mi_TileMinX * md_TileSize, dfPixelSize, 0,
+			90.0 - mi_TileMinY * md_TileSize, 0, -dfPixelSize};
+	poVDS->SetGeoTransform(adfGeoTransform);
+	poVDS->SetProjection(sTileWKT.c_str());
+
+	for (int iBand = 1; iBand <= nBands; iBand++)
+	{
+		poVDS->AddBand(eDataType, NULL);
+		VRTSourcedRasterBand* poVRTBand = (VRTSourcedRasterBand*) poVDS->GetRasterBand(iBand);
+		poVRTBand->SetNoDataValue(mp_AbsDS->GetMissingValue());
+		for (int iy = mi_TileMinY; iy <= mi_TileMaxY; iy++)
+			for (int ix = mi_TileMinX; ix <= mi_TileMaxX; ix++)
+				poVRTBand->AddSimpleSource(GetTileFileName(ix, iy).c_str(), iBand, 0, 0, mi_TilePixels, mi_TilePixels,
+						(ix - mi_TileMinX) * mi_TilePixels, (iy - mi_TileMinY) * mi_TilePixels, mi_TilePixels, mi_TilePixels);
+	}
+	GDALClose(poVDS);
+
+	//step 3: cut the request out of the mosaic
+	string sTranslateCmd = mp_Conf->Get_GDAL_TRANSLATE_PATH() + " -q -of GTiff" + sTiffCmdOptions;
+	string sCacheMax = mp_Conf->Get_GDAL_CACHE_MAX();
+	if (!EQUAL(sCacheMax.c_str(), ""))
+		sTranslateCmd += " --config GDAL_CACHEMAX " + sCacheMax;
+	sTranslateCmd += CPLString().Printf(" -projwin %.12g %.12g %.12g %.12g",
+			md_RequestMinX, md_RequestMaxY, md_RequestMaxX, md_RequestMinY);
+	if (!mvi_OutputWH.empty())
+		sTranslateCmd += " -outsize " + convertToString(mvi_OutputWH.at(0)) + " " + convertToString(mvi_OutputWH.at(1));
+	else if (!mvd_OutputResXY.empty())
+		sTranslateCmd += " -tr " + convertToString(mvd_OutputResXY.at(0)) + " " + convertToString(mvd_OutputResXY.at(1));
+	sTranslateCmd += " -r " + ms_Interpolation;
+	sTranslateCmd += " " + sVRTFileName + " " + sWarpFileName;
+
+	CPLErr eErr = ExeCommand(mp_Conf->Get_WCS_LOGFILE_PATH(), sTranslateCmd);
+	unlink(sVRTFileName.c_str());
+	if (CE_None != eErr || GetFileByteSize(sWarpFileName) < 0)
+	{
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateTileGridWarpFile()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to cut the request out of the tiles.");
+		return CE_Failure;
+	}
+
+	//The tiles of this request are still pinned and kept, the least recently used ones are removed
+	mp_TileCache->Evict();
+	mp_TileCache->Unpin();
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                        IsAntimeridianRequest()                       */
+/************************************************************************/
+
+/**
+ * \brief Whether the request crosses the antimeridian.
+ *
+ * This method is used to check whether the spatial subset of the request is
+ * in the geographic CRS of the output and crosses the antimeridian, either
+ * with a west bound greater than the east bound, or an east bound beyond 180.
+ *
+ * @return TRUE if the request crosses the antimeridian, FALSE otherwise.
+ */
+
+int WCS_GetCoverage::IsAntimeridianRequest()
+{
+	if (!mb_SubsetSpatial)
+		return FALSE;
+
+	int bGeographic;
+	if (ms_ResponseCRS_URN != "")
+		bGeographic = IsGeographicCRS(mp_ResponseRegCRS, mo_ResponseCRS);
+	else if (ms_RequestCRS_URN != "")
+		bGeographic = IsGeographicCRS(mp_RequestedRegCRS, mo_RequestedCRS);
+	else
+		bGeographic = mp_AbsDS->GetNativeCRS().IsGeographic();
+	if (!bGeographic)
+		return FALSE;
+
+	if (md_RequestMinX < -180.0 || md_RequestMinX >= 180.0 || md_RequestMaxX > 360.0)
+		return FALSE;
+
+	return md_RequestMinX > md_RequestMaxX || md_RequestMaxX > 180.0;
+}
+
+/************************************************************************/
+/*                      CreateAntimeridianWarpFile()                    */
+/************************************************************************/
+
+/**
+ * \brief Create the warp result of a request crossing the antimeridian.
+ *
+ * This method is used to split the request into two windows, from the west
+ * bound to 180 and from -180 to the east bound, so that each gdalwarp only
+ * reads the source window on its side of the antimeridian rather than the
+ * whole width of the coverage. The two windows are warped in parallel with
+ * the same resolution, then stitched side by side with a VRT dataset whose
+ * longitudes continue beyond 180, and copied to the warp result.
+ *
+ * @param sSrcName The path of the warp source.
+ *
+ * @param sWarpFileName The path of the warp result.
+ *
+ * @param sWarpCmd The gdalwarp command line with the options and target CRS,
+ * without the extent, size, source and destination.
+ *
+ * @param sTiffCmdOptions The creation options of the intermediate files.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr WCS_GetCoverage::CreateAntimeridianWarpFile(const string& sSrcName, const string& sWarpFileName,
+		const string& sWarpCmd, const string& sTiffCmdOptions)
+{
+	double dfMaxX = md_RequestMaxX <= md_RequestMinX ? md_RequestMaxX + 360.0 : md_RequestMaxX;
+
+	double dfResX, dfResY;
+	if (!mvd_OutputResXY.empty())
+	{
+		dfResX = mvd_OutputResXY.at(0);
+		dfResY = mvd_OutputResXY.at(1);
+	}
+	else if (!mvi_OutputWH.empty() && mvi_OutputWH.at(0) > 0 && mvi_OutputWH.at(1) > 0)
+	{
+		dfResX = (dfMaxX - md_RequestMinX) / mvi_OutputWH.at(0);
+		dfResY = (md_RequestMaxY - md_RequestMinY) / mvi_OutputWH.at(1);
+	}
+	else
+	{
+		dfResX = md_OutGeoTransform[1];
+		dfResY = fabs(md_OutGeoTransform[5]);
+	}
+
+	int nXSize = (int)((dfMaxX - md_RequestMinX) / dfResX + 0.5);
+	int nYSize = (int)((md_RequestMaxY - md_RequestMinY) / dfResY + 0.5);
+	int nWestXSize = (int)((180.0 - md_RequestMinX) / dfResX + 0.5);
+	if (!(dfResX > 0) || !(dfResY > 0) || nXSize < 2 || nYSize < 1)
+	{
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateAntimeridianWarpFile()");
+		WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "Invalid output size of the request crossing the antimeridian.");
+		return CE_Failure;
+	}
+	nWestXSize = MAX(1, MIN(nXSize - 1, nWestXSize));
+	int nEastXSize = nXSize - nWestXSize;
+	double dfSplitX = md_RequestMinX + nWestXSize * dfResX;
+	//The grid is anchored at the north edge of the request, as the output of gdalwarp
+	double dfMinY = md_RequestMaxY - nYSize * dfResY;
+
+	//step 1: warp both windows in parallel
+	string sWestFileName = sWarpFileName + ".west.tif";
+	string sEastFileName = sWarpFileName + ".east.tif";
+	string sOptions = " -dstnodata " + convertToString(mp_AbsDS->GetMissingValue()) + " -r " + ms_Interpolation;
+	string sWestCmd = sWarpCmd + CPLString().Printf(" -te %.12g %.12g %.12g %.12g -ts %d %d",
+			md_RequestMinX, dfMinY, dfSplitX, md_RequestMaxY, nWestXSize, nYSize) +
+			sOptions + " " + sSrcName + " " + sWestFileName;
+	string sEastCmd = sWarpCmd + CPLString().Printf(" -te %.12g %.12g %.12g %.12g -ts %d %d",
+			dfSplitX - 360.0, dfMinY, dfMaxX - 360.0, md_RequestMaxY, nEastXSize, nYSize) +
+			sOptions + " " + sSrcName + " " + sEastFileName;
+
+	//The exit status of each gdalwarp is checked, the output of a failed one is removed, so that
+	//a partial window is never stitched
+	string sSplitCmd = "(" + sWestCmd + ") & WEST_PID=$!; " +
+			sEastCmd + " || rm -f " + sEastFileName + "; " +
+			"wait $WEST_PID || rm -f " + sWestFileName;
+	unlink(sWestFileName.c_str());
+	unlink(sEastFileName.c_str());
+	if (CE_None != ExeCommand(mp_Conf->Get_WCS_LOGFILE_PATH(), sSplitCmd) ||
+		GetFileByteSize(sWestFileName) < 0 || GetFileByteSize(sEastFileName) < 0)
+	{
+		unlink(sWestFileName.c_str());
+		unlink(sEastFileName.c_str());
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateAntimeridianWarpFile()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to warp the request crossing the antimeridian.");
+		return CE_Failure;
+	}
+
+	//step 2: stitch the windows with a VRT dataset
+	GDALDataset* poWestDS = (GDALDataset*) GDALOpen(sWestFileName.c_str(), GA_ReadOnly);
+	if (!poWestDS || poWestDS->GetRasterCount() < 1)
+	{
+		if (poWestDS)
+			GDALClose(poWestDS);
+		unlink(sWestFileName.c_str());
+		unlink(sEastFileName.c_str());
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateAntimeridianWarpFile()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to open the warped window.");
+		return CE_Failure;
+	}
+	int nBands = poWestDS->GetRasterCount();
+	GDALDataType eDataType = poWestDS->GetRasterBand(1)->GetRasterDataType();
+	string sWKT = poWestDS->GetProjectionRef();
+	GDALClose(poWestDS);
+
+	string sVRTFileName = sWarpFileName + ".vrt";
+	GDALDriver* poVRTDriver = (GDALDriver*) GDALGetDriverByName("VRT");
+	VRTDataset* poVDS = poVRTDriver ?
+			(VRTDataset*) poVRTDriver->Create(sVRTFileName.c_str(), nXSize, nYSize, 0, eDataType, NULL) : NULL;
+	if (!poVDS)
+	{
+		unlink(sWestFileName.c_str());
+		unlink(sEastFileName.c_str());
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateAntimeridianWarpFile()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to create VRT DataSet.");
+		return CE_Failure;
+	}
+
+	double adfGeoTransform[6] = {md_RequestMinX, dfResX, 0, md_RequestMaxY, 0, -dfResY};
+	poVDS->SetGeoTransform(adfGeoTransform);
+	poVDS->SetProjection(sWKT.c_str());
+
+	for (int iBand = 1; iBand <= nBands; iBand++)
+	{
+		poVDS->AddBand(eDataType, NULL);
+		VRTSourcedRasterBand* poVRTBand = (VRTSourcedRasterBand*) poVDS->GetRasterBand(iBand);
+		poVRTBand->SetNoDataValue(mp_AbsDS->GetMissingValue());
+		poVRTBand->AddSimpleSource(sWestFileName.c_str(), iBand, 0, 0, nWestXSize, nYSize, 0, 0, nWestXSize, nYSize);
+		poVRTBand->AddSimpleSource(sEastFileName.c_str(), iBand, 0, 0, nEastXSize, nYSize, nWestXSize, 0, nEastXSize, nYSize);
+	}
+	GDALClose(poVDS);
+
+	string sTranslateCmd = mp_Conf->Get_GDAL_TRANSLATE_PATH() + " -q -of GTiff" + sTiffCmdOptions;
+	string sCacheMax = mp_Conf->Get_GDAL_CACHE_MAX();
+	if (!EQUAL(sCacheMax.c_str(), ""))
+		sTranslateCmd += " --config GDAL_CACHEMAX " + sCacheMax;
+	sTranslateCmd += " " + sVRTFileName + " " + sWarpFileName;
+
+	CPLErr eErr = ExeCommand(mp_Conf->Get_WCS_LOGFILE_PATH(), sTranslateCmd);
+	unlink(sVRTFileName.c_str());
+	unlink(sWestFileName.c_str());
+	unlink(sEastFileName.c_str());
+	if (CE_None != eErr || GetFileByteSize(sWarpFileName) < 0)
+	{
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateAntimeridianWarpFile()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to stitch the windows of the request crossing the antimeridian.");
+		return CE_Failure;
+	}
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                          IsOutputTooLarge()                          */
+/************************************************************************/
+
+/**
+ * \brief Whether the output is larger than MAX_OUTPUT_DIMENSION.
+ *
+ * This method is used to check the output size before it is warped or
+ * resampled, the size is not limited if MAX_OUTPUT_DIMENSION is not set.
+ *
+ * @param nWidth The width of the output, in pixels.
+ *
+ * @param nHeight The height of the output, in pixels.
+ *
+ * @return TRUE if the output is too large, FALSE otherwise.
+ */
+
+int WCS_GetCoverage::IsOutputTooLarge(int nWidth, int nHeight)
+{
+	string sMaxDimension = mp_Conf->Get_MAX_OUTPUT_DIMENSION();
+	int nMaxDimension = atoi(sMaxDimension.c_str());
+	return nMaxDimension > 0 && (nWidth > nMaxDimension || nHeight > nMaxDimension);
+}
+
+/************************************************************************/
+/*                           IsSwathCoverage()                          */
+/************************************************************************/
+
+/**
+ * \brief Whether the coverage is an HDF-EOS2 or HDF-EOS5 swath.
+ *
+ * @return TRUE if the coverage is a swath, FALSE otherwise.
+ */
+
+int WCS_GetCoverage::IsSwathCoverage()
+{
+	return ms_CovGDALID.find("EOS_SWATH") != string::npos ||
+		(EQUALN(ms_CovGDALID.c_str(), "HDF5:", 5) && Find_Compare_SubStr(ms_CovGDALID, "HDFEOS/SWATHS"));
+}
+
+/************************************************************************/
+/*                      HasSwathGeolocationArrays()                     */
+/************************************************************************/
+
+/**
+ * \brief Whether the swath has geolocation arrays when opened by gdalwarp.
+ *
+ * The coverage is opened as gdalwarp does with GEOL_AS_GCPS=NONE, and its
+ * GEOLOCATION metadata is checked. The GDAL driver of HDF-EOS5 swaths only
+ * gives the geolocation arrays from some versions, otherwise the swath is
+ * rectified with its GCPs.
+ *
+ * @return TRUE if the swath has X and Y geolocation arrays, FALSE otherwise.
+ */
+
+int WCS_GetCoverage::HasSwathGeolocationArrays()
+{
+	CPLSetThreadLocalConfigOption("GEOL_AS_GCPS", "NONE");
+	GDALDataset* poSrcDS = (GDALDataset*) GDALOpen(ms_CovGDALID.c_str(), GA_ReadOnly);
+	CPLSetThreadLocalConfigOption("GEOL_AS_GCPS", NULL);
+	if (!poSrcDS)
+		return FALSE;
+	char** papszGeolocation = poSrcDS->GetMetadata("GEOLOCATION");
+	int bHasArrays = CSLFetchNameValue(papszGeolocation, "X_DATASET") && CSLFetchNameValue(papszGeolocation, "Y_DATASET");
+	GDALClose(poSrcDS);
+
+	return bHasArrays;
+}
+
+/************************************************************************/
+/*                        IsSwathNearestRequest()                       */
+/************************************************************************/
+
+/**
+ * \brief Whether the request is resampled from a swath with the nearest neighbor.
+ *
+ * This method is used to check whether the coverage is an HDF-EOS2 or
+ * HDF-EOS5 swath, the interpolation is nearest and the output CRS is
+ * geographic, so that the swath is resampled in process rather than warped.
+ *
+ * @return TRUE if the request is resampled in process, FALSE otherwise.
+ */
+
+int WCS_GetCoverage::IsSwathNearestRequest()
+{
+	if (ms_Interpolation != "near")
+		return FALSE;
+	if (!IsSwathCoverage())
+		return FALSE;
+
+	if (ms_ResponseCRS_URN != "")
+		return IsGeographicCRS(mp_ResponseRegCRS, mo_ResponseCRS);
+	else if (ms_RequestCRS_URN != "")
+		return IsGeographicCRS(mp_RequestedRegCRS, mo_RequestedCRS);
+	else
+		return mp_AbsDS->GetNativeCRS().IsGeographic();
+}
+
+/************************************************************************/
+/*                      CreateSwathNearestWarpFile()                    */
+/************************************************************************/
+
+/**
+ * \brief Create the warp result of a swath with the nearest neighbor resampler.
+ *
+ * This method is used to replace gdalwarp for the nearest neighbor requests
+ * on swaths. The output grid is derived from the requested bounding box
+ * (transformed to the output CRS), size or resolution, and the swath pixels
+ * are resampled to it by AbstractDataset::ResampleSwathNearest(). The size
+ * of the grid is checked against MAX_OUTPUT_DIMENSION before the resampler
+ * runs. On failure no error is raised and no warp result is left, so that
+ * the request could be warped by gdalwarp, which reports its own errors.
+ *
+ * @param sWarpFileName The path of the warp result.
+ *
+ * @param papszTiffOptions The creation options of the intermediate files.
+ *
+ * @return CE_None on success, CE_Warning if the swath could not be resampled
+ * in process, or CE_Failure on failure.
+ */
+
+CPLErr WCS_GetCoverage::CreateSwathNearestWarpFile(const string& sWarpFileName, char** papszTiffOptions)
+{
+	//The bounding box in the output CRS
+	My2DPoint llPt(md_RequestMinX, md_RequestMinY);
+	My2DPoint urPt(md_RequestMaxX, md_RequestMaxY);
+	if (ms_ResponseCRS_URN != "" && mb_SubsetSpatial && !mo_RequestedCRS.IsSame(&mo_ResponseCRS) &&
+		CE_None != bBox_transFormmate(mo_RequestedCRS, mo_ResponseCRS, llPt, urPt))
+		return CE_Failure;
+
+	double dfWidth = urPt.mi_X > llPt.mi_X ? urPt.mi_X - llPt.mi_X : urPt.mi_X + 360.0 - llPt.mi_X;
+	double dfHeight = urPt.mi_Y - llPt.mi_Y;
+
+	int nXSize, nYSize;
+	if (!mvi_OutputWH.empty())
+	{
+		nXSize = mvi_OutputWH.at(0);
+		nYSize = mvi_OutputWH.at(1);
+	}
+	else
+	{
+		double dfResX = mvd_OutputResXY.empty() ? md_OutGeoTransform[1] : mvd_OutputResXY.at(0);
+		double dfResY = mvd_OutputResXY.empty() ? fabs(md_OutGeoTransform[5]) : mvd_OutputResXY.at(1);
+		nXSize = dfResX > 0 ? (int)(dfWidth / dfResX + 0.5) : 0;
+		nYSize = dfResY > 0 ? (int)(dfHeight / dfResY + 0.5) : 0;
+	}
+	//The request is left to gdalwarp, which reports the invalid or too large output
+	if (nXSize < 1 || nYSize < 1 || !(dfHeight > 0) || IsOutputTooLarge(nXSize, nYSize))
+		return CE_Failure;
+	double adfGeoTransform[6] = {llPt.mi_X, dfWidth / nXSize, 0, urPt.mi_Y, 0, -dfHeight / nYSize};
+
+	char* pszWKT = NULL;
+	if (ms_ResponseCRS_URN != "")
+		mo_ResponseCRS.exportToWkt(&pszWKT);
+	else if (ms_RequestCRS_URN != "")
+		mo_RequestedCRS.exportToWkt(&pszWKT);
+	else
+		mp_AbsDS->GetNativeCRS().exportToWkt(&pszWKT);
+
+	unlink(sWarpFileName.c_str());
+	CPLErr eErr = mp_AbsDS->ResampleSwathNearest(sWarpFileName, adfGeoTransform, nXSize, nYSize, pszWKT,
+			atof(mp_Conf->Get_SWATH_NEAREST_MAX_DISTANCE().c_str()), papszTiffOptions);
+	CPLFree(pszWKT);
+	if (CE_None != eErr)
+		unlink(sWarpFileName.c_str());
+
+	return eErr;
+}
+
+/************************************************************************/
+/*                       CreateSwathRangeSources()                      */
+/************************************************************************/
+
+/**
+ * \brief Create the warp sources of the scanlines intersecting the request.
+ *
+ * This method is used to avoid reading and rectifying all scanlines of a
+ * swath for a small request, HDF-EOS2 and HDF-EOS5 swaths or any coverage
+ * with geolocation arrays. The scanline ranges intersecting the request
+ * (or its tiles) are found from the bounding boxes of the scan blocks of
+ * the cached geolocation, or from the geolocation arrays if the swath has
+ * no GCPs, see GetGeolocationRanges(), and a VRT dataset is created for each range. The
+ * geolocation arrays are subset to the lines of the range, in VRT datasets
+ * named after the range with ".x.vrt" and ".y.vrt", so that gdalwarp only
+ * builds the backward map of the range. Nothing is created, and the whole swath
+ * is read, when the request is not in geographic CRS, the swath has no
+ * geolocation arrays, or the ranges cover all scanlines.
+ *
+ * @param sOutFileName The output file name, prefix of the VRT datasets.
+ *
+ * @param bTileGrid Whether the request is assembled from the tile grid.
+ *
+ * @param vsSourceFiles The paths of the created VRT datasets.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr WCS_GetCoverage::CreateSwathRangeSources(const string& sOutFileName, int bTileGrid, vector<string>& vsSourceFiles)
+{
+	vsSourceFiles.clear();
+
+	double dfMinX = md_RequestMinX, dfMinY = md_RequestMinY, dfMaxX = md_RequestMaxX, dfMaxY = md_RequestMaxY;
+	if (bTileGrid)
+	{
+		dfMinX = -180.0 + mi_TileMinX * md_TileSize;
+		dfMinY = 90.0 - (mi_TileMaxY + 1) * md_TileSize;
+		dfMaxX = -180.0 + (mi_TileMaxX + 1) * md_TileSize;
+		dfMaxY = 90.0 - mi_TileMinY * md_TileSize;
+	}
+	else if (!mb_SubsetSpatial || (ms_RequestCRS_URN != "" && !IsGeographicCRS(mp_RequestedRegCRS, mo_RequestedCRS)))
+		return CE_None;
+	if (dfMaxX > 180.0)
+		dfMaxX -= 360.0;
+
+	GDALDataset* poInDS = (GDALDataset*) mp_AbsDS->GetGDALDataset();
+	if (!poInDS)
+		return CE_None;
+	int nLines = poInDS->GetRasterYSize();
+
+	//Opened as gdalwarp does, with the geolocation arrays
+	CPLSetThreadLocalConfigOption("GEOL_AS_GCPS", "NONE");
+	GDALDataset* poSrcDS = (GDALDataset*) GDALOpen(ms_CovGDALID.c_str(), GA_ReadOnly);
+	CPLSetThreadLocalConfigOption("GEOL_AS_GCPS", NULL);
+	if (!poSrcDS)
+		return CE_None;
+	char** papszGeolocation = CSLDuplicate(poSrcDS->GetMetadata("GEOLOCATION"));
+	GDALDriver* poVRTDriver = (GDALDriver*) GDALGetDriverByName("VRT");
+	if (!poVRTDriver || poSrcDS->GetRasterCount() < 1 || poSrcDS->GetRasterYSize() != nLines ||
+		!CSLFetchNameValue(papszGeolocation, "X_DATASET") || !CSLFetchNameValue(papszGeolocation, "Y_DATASET"))
+	{
+		CSLDestroy(papszGeolocation);
+		GDALClose(poSrcDS);
+		return CE_None;
+	}
+	double dfLineOffset = CPLAtof(CSLFetchNameValueDef(papszGeolocation, "LINE_OFFSET", "0"));
+	double dfLineStep = CPLAtof(CSLFetchNameValueDef(papszGeolocation, "LINE_STEP", "1"));
+	if (dfLineStep <= 0)
+		dfLineStep = 1;
+
+	//The geolocation arrays, which are subset to the lines of each range
+	GDALDataset* apoGeolDS[2];
+	GDALRasterBand* apoGeolBand[2] = {NULL, NULL};
+	apoGeolDS[0] = (GDALDataset*) GDALOpen(CSLFetchNameValue(papszGeolocation, "X_DATASET"), GA_ReadOnly);
+	apoGeolDS[1] = (GDALDataset*) GDALOpen(CSLFetchNameValue(papszGeolocation, "Y_DATASET"), GA_ReadOnly);
+	if (apoGeolDS[0])
+		apoGeolBand[0] = apoGeolDS[0]->GetRasterBand(atoi(CSLFetchNameValueDef(papszGeolocation, "X_BAND", "1")));
+	if (apoGeolDS[1])
+		apoGeolBand[1] = apoGeolDS[1]->GetRasterBand(atoi(CSLFetchNameValueDef(papszGeolocation, "Y_BAND", "1")));
+	if (!apoGeolBand[0] || !apoGeolBand[1])
+	{
+		for (int k = 0; k < 2; k++)
+			if (apoGeolDS[k])
+				GDALClose(apoGeolDS[k]);
+		CSLDestroy(papszGeolocation);
+		GDALClose(poSrcDS);
+		return CE_None;
+	}
+	int nGeolXSize = apoGeolBand[0]->GetXSize();
+	int nGeolYSize = apoGeolBand[0]->GetYSize();
+
+	//The ranges are found from the GCPs of the swath, or from the geolocation arrays if it has none
+	vector<int> anRanges;
+	if (CE_None != mp_AbsDS->GetScanlineRanges(dfMinX, dfMinY, dfMaxX, dfMaxY, anRanges))
+		GetGeolocationRanges(apoGeolBand[0], apoGeolBand[1], dfLineOffset, dfLineStep, nLines,
+				dfMinX, dfMinY, dfMaxX, dfMaxY, anRanges);
+	int nReadLines = 0;
+	for (unsigned int i = 1; i < anRanges.size(); i += 2)
+		nReadLines += anRanges[i];
+	if (anRanges.empty() || nReadLines >= nLines)
+	{
+		GDALClose(apoGeolDS[0]);
+		GDALClose(apoGeolDS[1]);
+		CSLDestroy(papszGeolocation);
+		GDALClose(poSrcDS);
+		return CE_None;
+	}
+
+	int nXSize = poSrcDS->GetRasterXSize();
+	for (unsigned int i = 0; i + 1 < anRanges.size(); i += 2)
+	{
+		int nStartLine = anRanges[i];
+		int nRangeLines = anRanges[i + 1];
+		string sVRTFileName = sOutFileName + CPLString().Printf(".tmp.%d.vrt", nStartLine);
+		VRTDataset* poVDS = (VRTDataset*) poVRTDriver->Create(sVRTFileName.c_str(), nXSize, nRangeLines, 0, GDT_Byte, NULL);
+		if (!poVDS)
+		{
+			CSLDestroy(papszGeolocation);
+			GDALClose(apoGeolDS[0]);
+			GDALClose(apoGeolDS[1]);
+			GDALClose(poSrcDS);
+			for (unsigned int j = 0; j < vsSourceFiles.size(); j++)
+			{
+				unlink(vsSourceFiles[j].c_str());
+				unlink((vsSourceFiles[j] + ".x.vrt").c_str());
+				unlink((vsSourceFiles[j] + ".y.vrt").c_str());
+			}
+			vsSourceFiles.clear();
+			SetWCS_ErrorLocator("WCS_GetCoverage::CreateSwathRangeSources()");
+			WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to create VRT DataSet.");
+			return CE_Failure;
+		}
+
+		//Only the geolocation lines of the range, so that gdalwarp builds the backward map of the range
+		int nGeolFirst = MAX(0, (int)floor((nStartLine - dfLineOffset) / dfLineStep));
+		int nGeolLast = MIN(nGeolYSize - 1, (int)ceil((nStartLine + nRangeLines - 1 - dfLineOffset) / dfLineStep));
+		nGeolLast = MAX(nGeolFirst, nGeolLast);
+		int nGeolLines = nGeolLast - nGeolFirst + 1;
+		for (int k = 0; k < 2; k++)
+		{
+			string sGeolFileName = sVRTFileName + (k == 0 ? ".x.vrt" : ".y.vrt");
+			VRTDataset* poGeolVDS = (VRTDataset*) poVRTDriver->Create(sGeolFileName.c_str(), nGeolXSize, nGeolLines, 0, GDT_Byte, NULL);
+			if (!poGeolVDS)
+			{
+				//The range would be warped without its geolocation arrays
+				GDALClose(poVDS);
+				vsSourceFiles.push_back(sVRTFileName);
+				CSLDestroy(papszGeolocation);
+				GDALClose(apoGeolDS[0]);
+				GDALClose(apoGeolDS[1]);
+				GDALClose(poSrcDS);
+				for (unsigned int j = 0; j < vsSourceFiles.size(); j++)
+				{
+					unlink(vsSourceFiles[j].c_str());
+					unlink((vsSourceFiles[j] + ".x.vrt").c_str());
+					unlink((vsSourceFiles[j] + ".y.vrt").c_str());
+				}
+				vsSourceFiles.clear();
+				SetWCS_ErrorLocator("WCS_GetCoverage::CreateSwathRangeSources()");
+				WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to create the VRT DataSet of the geolocation array.");
+				return CE_Failure;
+			}
+			poGeolVDS->AddBand(apoGeolBand[k]->GetRasterDataType(), NULL);
+			VRTSourcedRasterBand* poGeolBand = (VRTSourcedRasterBand*) poGeolVDS->GetRasterBand(1);
+			int bHasNoData = FALSE;
+			double dfNoData = apoGeolBand[k]->GetNoDataValue(&bHasNoData);
+			if (bHasNoData)
+				poGeolBand->SetNoDataValue(dfNoData);
+			poGeolBand->AddSimpleSource(apoGeolBand[k], 0, nGeolFirst, nGeolXSize, nGeolLines, 0, 0, nGeolXSize, nGeolLines);
+			GDALClose(poGeolVDS);
+			papszGeolocation = CSLSetNameValue(papszGeolocation, k == 0 ? "X_DATASET" : "Y_DATASET", sGeolFileName.c_str());
+			papszGeolocation = CSLSetNameValue(papszGeolocation, k == 0 ? "X_BAND" : "Y_BAND", "1");
+		}
+		papszGeolocation = CSLSetNameValue(papszGeolocation, "LINE_OFFSET",
+				CPLString().Printf("%.12g", dfLineOffset + nGeolFirst * dfLineStep - nStartLine));
+		poVDS->SetMetadata(papszGeolocation, "GEOLOCATION");
+
+		for (int iBand = 1; iBand <= poSrcDS->GetRasterCount(); iBand++)
+		{
+			GDALRasterBand* poSrcBand = poSrcDS->GetRasterBand(iBand);
+			poVDS->AddBand(poSrcBand->GetRasterDataType(), NULL);
+			VRTSourcedRasterBand* poVRTBand = (VRTSourcedRasterBand*) poVDS->GetRasterBand(iBand);
+			int bHasNoData = FALSE;
+			double dfNoData = poSrcBand->GetNoDataValue(&bHasNoData);
+			if (bHasNoData)
+				poVRTBand->SetNoDataValue(dfNoData);
+			poVRTBand->AddSimpleSource(poSrcBand, 0, nStartLine, nXSize, nRangeLines, 0, 0, nXSize, nRangeLines);
+		}
+		GDALClose(poVDS);
+		vsSourceFiles.push_back(sVRTFileName);
+	}
+
+	CSLDestroy(papszGeolocation);
+	GDALClose(apoGeolDS[0]);
+	GDALClose(apoGeolDS[1]);
+	GDALClose(poSrcDS);
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                        GetGeolocationRanges()                        */
+/************************************************************************/
+
+/**
+ * \brief Find the scanline ranges intersecting a bounding box from the geolocation arrays.
+ *
+ * This method is used for the swaths without GCPs, whose geolocation is
+ * only given by the X (longitude) and Y (latitude) arrays. The arrays are
+ * read line by line, and the bounding box of each geolocation line is
+ * tested as the scan blocks of AbstractDataset::GetScanlineRanges(). The
+ * scanlines of the intersecting geolocation lines, with one geolocation
+ * line of margin on each side, are merged into ranges.
+ *
+ * @param poXBand The X (longitude) geolocation array.
+ *
+ * @param poYBand The Y (latitude) geolocation array.
+ *
+ * @param dfLineOffset The scanline of the first geolocation line.
+ *
+ * @param dfLineStep The number of scanlines between the geolocation lines.
+ *
+ * @param nLines The number of scanlines of the swath.
+ *
+ * @param dfMinX The west bound of the request, it could be greater than the
+ * east bound when the request crosses the antimeridian.
+ *
+ * @param dfMinY The south bound of the request.
+ *
+ * @param dfMaxX The east bound of the request.
+ *
+ * @param dfMaxY The north bound of the request.
+ *
+ * @param anRanges The first scanline and the number of scanlines of each
+ * range, empty if no scanline intersects the request.
+ *
+ * @return CE_None on success or CE_Failure if the arrays could not be read.
+ */
+
+CPLErr WCS_GetCoverage::GetGeolocationRanges(GDALRasterBand* poXBand, GDALRasterBand* poYBand,
+		double dfLineOffset, double dfLineStep, int nLines,
+		double dfMinX, double dfMinY, double dfMaxX, double dfMaxY, vector<int>& anRanges)
+{
+	anRanges.clear();
+	int nGeolXSize = poXBand->GetXSize();
+	int nGeolYSize = MIN(poXBand->GetYSize(), poYBand->GetYSize());
+	if (nGeolXSize != poYBand->GetXSize() || nGeolYSize < 1 || nLines < 1)
+		return CE_Failure;
+
+	int bHasXNoData = FALSE, bHasYNoData = FALSE;
+	double dfXNoData = poXBand->GetNoDataValue(&bHasXNoData);
+	double dfYNoData = poYBand->GetNoDataValue(&bHasYNoData);
+	int bCrossRequest = dfMinX > dfMaxX;
+	vector<double> adfX(nGeolXSize), adfY(nGeolXSize);
+	vector<int> abHit(nGeolYSize, FALSE);
+	for (int g = 0; g < nGeolYSize; g++)
+	{
+		if (CE_None != poXBand->RasterIO(GF_Read, 0, g, nGeolXSize, 1, &adfX[0], nGeolXSize, 1, GDT_Float64, 0, 0) ||
+			CE_None != poYBand->RasterIO(GF_Read, 0, g, nGeolXSize, 1, &adfY[0], nGeolXSize, 1, GDT_Float64, 0, 0))
+		{
+			anRanges.clear();
+			return CE_Failure;
+		}
+		double dfLMinX = 180.0, dfLMaxX = -180.0, dfLMinY = 90.0, dfLMaxY = -90.0;
+		for (int i = 0; i < nGeolXSize; i++)
+		{
+			if ((bHasXNoData && adfX[i] == dfXNoData) || (bHasYNoData && adfY[i] == dfYNoData) ||
+				!(fabs(adfX[i]) <= 180.0) || !(fabs(adfY[i]) <= 90.0))
+				continue;
+			dfLMinX = MIN(dfLMinX, adfX[i]);
+			dfLMaxX = MAX(dfLMaxX, adfX[i]);
+			dfLMinY = MIN(dfLMinY, adfY[i]);
+			dfLMaxY = MAX(dfLMaxY, adfY[i]);
+		}
+		if (dfLMinY > dfLMaxY || dfLMaxY < dfMinY || dfLMinY > dfMaxY)
+			continue;
+		if (dfLMaxX - dfLMinX > 180.0)//crossing the antimeridian, only the latitudes are tested
+			abHit[g] = TRUE;
+		else if (bCrossRequest)
+			abHit[g] = dfLMaxX >= dfMinX || dfLMinX <= dfMaxX;
+		else
+			abHit[g] = dfLMaxX >= dfMinX && dfLMinX <= dfMaxX;
+	}
+
+	for (int g = 0; g < nGeolYSize; g++)
+	{
+		if (!abHit[g])
+			continue;
+		int nFirst = g;
+		while (g + 1 < nGeolYSize && abHit[g + 1])
+			g++;
+		int nStartLine = MAX(0, (int)floor(dfLineOffset + (nFirst - 1) * dfLineStep));
+		int nEndLine = MIN(nLines, (int)ceil(dfLineOffset + (g + 1) * dfLineStep) + 1);
+		if (nEndLine <= nStartLine)
+			continue;
+		if (!anRanges.empty() && anRanges[anRanges.size() - 2] + anRanges.back() >= nStartLine)
+			anRanges.back() = MAX(anRanges.back(), nEndLine - anRanges[anRanges.size() - 2]);
+		else
+		{
+			anRanges.push_back(nStartLine);
+			anRanges.push_back(nEndLine - nStartLine);
+		}
+	}
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                          GetSourceWindows()                          */
+/************************************************************************/
+
+/**
+ * \brief Get the windows of the coverage in pixels around the request.
+ *
+ * The bounding box is transformed to the native CRS of the coverage and
+ * located with its geotransform. The window is the whole coverage if the
+ * bounding box could not be located, e.g. if the coverage has no north-up
+ * geotransform. A geographic bounding box crossing the antimeridian (west
+ * bound greater than the east bound, or east bound beyond 180) is windowed
+ * on each side of it, [west, 180] and [-180, east], so there are two windows
+ * near the edges of a global coverage rather than its whole rows. A window
+ * outside the coverage is left out.
+ *
+ * @param bSubset Whether the windows are limited by the bounding box.
+ *
+ * @param dfMinX The minimum X of the bounding box, in the CRS of the request.
+ *
+ * @param dfMinY The minimum Y of the bounding box.
+ *
+ * @param dfMaxX The maximum X of the bounding box.
+ *
+ * @param dfMaxY The maximum Y of the bounding box.
+ *
+ * @param nMargin The margin, in pixels, added around the bounding box.
+ *
+ * @param anWindows The windows will be placed here, four numbers for each:
+ * the first column, the first line, the column after and the line after it.
+ */
+
+void WCS_GetCoverage::GetSourceWindows(int bSubset, double dfMinX, double dfMinY, double dfMaxX, double dfMaxY,
+		int nMargin, vector<int>& anWindows)
+{
+	GDALDataset* poSrcDS = (GDALDataset*)mp_AbsDS->GetGDALDataset();
+	int nXSize = poSrcDS->GetRasterXSize();
+	int nYSize = poSrcDS->GetRasterYSize();
+	int anWholeWindow[4] = {0, 0, nXSize, nYSize};
+	anWindows.assign(anWholeWindow, anWholeWindow + 4);
+
+	double adfGeoTransform[6];
+	if (!bSubset || CE_None != poSrcDS->GetGeoTransform(adfGeoTransform) ||
+		adfGeoTransform[2] != 0.0 || adfGeoTransform[4] != 0.0)
+		return;
+
+	OGRSpatialReference oNativeCRS = mp_AbsDS->GetNativeCRS();
+	int bBoxGeographic = ms_RequestCRS_URN != "" ?
+			IsGeographicCRS(mp_RequestedRegCRS, mo_RequestedCRS) : oNativeCRS.IsGeographic();
+	vector<double> adfBoxX;
+	adfBoxX.push_back(dfMinX);
+	if (bBoxGeographic && (dfMinX > dfMaxX || dfMaxX > 180.0))
+	{
+		adfBoxX.push_back(180.0);
+		adfBoxX.push_back(-180.0);
+		adfBoxX.push_back(dfMaxX > 180.0 ? dfMaxX - 360.0 : dfMaxX);
+	}
+	else
+		adfBoxX.push_back(dfMaxX);
+
+	vector<int> anBoxWindows;
+	for (size_t i = 0; i + 1 < adfBoxX.size(); i += 2)
+	{
+		My2DPoint llPt(adfBoxX[i], dfMinY);
+		My2DPoint urPt(adfBoxX[i + 1], dfMaxY);
+		if (!mo_RequestedCRS.IsSame(&oNativeCRS) &&
+			CE_None != bBox_transFormmate(mo_RequestedCRS, oNativeCRS, llPt, urPt))
+			return;
+
+		double dfPX0 = (llPt.mi_X - adfGeoTransform[0]) / adfGeoTransform[1];
+		double dfPX1 = (urPt.mi_X - adfGeoTransform[0]) / adfGeoTransform[1];
+		double dfPY0 = (urPt.mi_Y - adfGeoTransform[3]) / adfGeoTransform[5];
+		double dfPY1 = (llPt.mi_Y - adfGeoTransform[3]) / adfGeoTransform[5];
+		int nX0 = MAX(0, (int)floor(MIN(dfPX0, dfPX1)) - nMargin);
+		int nX1 = MIN(nXSize, (int)ceil(MAX(dfPX0, dfPX1)) + nMargin);
+		int nY0 = MAX(0, (int)floor(MIN(dfPY0, dfPY1)) - nMargin);
+		int nY1 = MIN(nYSize, (int)ceil(MAX(dfPY0, dfPY1)) + nMargin);
+		if (nX1 <= nX0 || nY1 <= nY0)
+			continue;
+		anBoxWindows.push_back(nX0);
+		anBoxWindows.push_back(nY0);
+		anBoxWindows.push_back(nX1);
+		anBoxWindows.push_back(nY1);
+	}
+
+	//The whole coverage if the bounding box is outside of it
+	if (!anBoxWindows.empty())
+		anWindows = anBoxWindows;
+}
+
+/************************************************************************/
+/*                        CreateWindowSourceFile()                      */
+/************************************************************************/
+
+/**
+ * \brief Create the warp sources from the windows of the coverage around the request.
+ *
+ * This method is used when the decoded blocks could not be shared through
+ * the cache directory. Only the windows of the coverage around the request
+ * (with a margin of 16 pixels for interpolation) are read and copied into
+ * GeoTIFF files, instead of the whole coverage, see GetSourceWindows(). A
+ * request crossing the antimeridian has a window on each side of it, in
+ * separate files which are both passed to gdalwarp. For the coverages
+ * rectified on the fly, e.g. GOES, only these windows are rectified.
+ *
+ * @param sTiffPrefix The path of the GeoTIFF files to be created, without
+ * the ".tif" extension. The second window is written to "<prefix>.1.tif".
+ *
+ * @param bSubset Whether the windows are limited by the bounding box.
+ *
+ * @param dfMinX The minimum X of the bounding box, in the CRS of the request.
+ *
+ * @param dfMinY The minimum Y of the bounding box.
+ *
+ * @param dfMaxX The maximum X of the bounding box.
+ *
+ * @param dfMaxY The maximum Y of the bounding box.
+ *
+ * @param papszTiffOptions The creation options of the GeoTIFF files.
+ *
+ * @param vsTiffFiles The paths of the created GeoTIFF files.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr WCS_GetCoverage::CreateWindowSourceFile(const string& sTiffPrefix, int bSubset,
+		double dfMinX, double dfMinY, double dfMaxX, double dfMaxY, char** papszTiffOptions,
+		vector<string>& vsTiffFiles)
+{
+	vsTiffFiles.clear();
+	GDALDataset* poSrcDS = (GDALDataset*)mp_AbsDS->GetGDALDataset();
+	GDALDriverH hOutDriver = GDALGetDriverByName("GTIFF");
+	GDALDriver* poVRTDriver = (GDALDriver*) GDALGetDriverByName("VRT");
+	if (!poSrcDS || poSrcDS->GetRasterCount() < 1 || !hOutDriver || !poVRTDriver)
+	{
+		SetWCS_ErrorLocator("WCS_GetCoverage::CreateWindowSourceFile()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to open the coverage.");
+		return CE_Failure;
+	}
+
+	vector<int> anWindows;
+	GetSourceWindows(bSubset, dfMinX, dfMinY, dfMaxX, dfMaxY, 16, anWindows);
+	int nBands = poSrcDS->GetRasterCount();
+
+	for (size_t iWindow = 0; iWindow + 3 < anWindows.size(); iWindow += 4)
+	{
+		int nX0 = anWindows[iWindow], nY0 = anWindows[iWindow + 1];
+		int nW = anWindows[iWindow + 2] - nX0, nH = anWindows[iWindow + 3] - nY0;
+		string sTiffFileName = iWindow == 0 ? sTiffPrefix + ".tif" :
+				sTiffPrefix + CPLString().Printf(".%d.tif", (int)(iWindow / 4));
+
+		//The window is an in-memory VRT dataset, with the geotransform shifted to its origin
+		VRTDataset* poVDS = (VRTDataset*) poVRTDriver->Create("", nW, nH, 0, GDT_Byte, NULL);
+		if (!poVDS)
+		{
+			for (size_t i = 0; i < vsTiffFiles.size(); i++)
+				unlink(vsTiffFiles[i].c_str());
+			vsTiffFiles.clear();
+			SetWCS_ErrorLocator("WCS_GetCoverage::CreateWindowSourceFile()");
+			WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to create \"VRT\" dataSet.");
+			return CE_Failure;
+		}
+
+		double adfGeoTransform[6];
+		if (CE_None == poSrcDS->GetGeoTransform(adfGeoTransform))
+		{
+			adfGeoTransform[0] += nX0 * adfGeoTransform[1] + nY0 * adfGeoTransform[2];
+			adfGeoTransform[3] += nX0 * adfGeoTransform[4] + nY0 * adfGeoTransform[5];
+			poVDS->SetGeoTransform(adfGeoTransform);
+		}
+		poVDS->SetProjection(poSrcDS->GetProjectionRef());
+
+		for (int iBand = 1; iBand <= nBands; iBand++)
+		{
+			GDALRasterBand* poSrcBand = poSrcDS->GetRasterBand(iBand);
+			poVDS->AddBand(poSrcBand->GetRasterDataType(), NULL);
+			VRTSourcedRasterBand* poVRTBand = (VRTSourcedRasterBand*) poVDS->GetRasterBand(iBand);
+			int bHasNoData = FALSE;
+			double dfNoData = poSrcBand->GetNoDataValue(&bHasNoData);
+			poVRTBand->SetNoDataValue(bHasNoData ? dfNoData : mp_AbsDS->GetMissingValue());
+			poVRTBand->AddSimpleSource(poSrcBand, nX0, nY0, nW, nH, 0, 0, nW, nH);
+		}
+
+		GDALDatasetH hOutDS = GDALCreateCopy(hOutDriver, sTiffFileName.c_str(), poVDS, FALSE, papszTiffOptions, NULL, NULL);
+		GDALClose(poVDS);
+		if (!hOutDS)
+		{
+			unlink(sTiffFileName.c_str());
+			for (size_t i = 0; i < vsTiffFiles.size(); i++)
+				unlink(vsTiffFiles[i].c_str());
+			vsTiffFiles.clear();
+			SetWCS_ErrorLocator("WCS_GetCoverage::CreateWindowSourceFile()");
+			WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to copy the window of the coverage.");
+			return CE_Failure;
+		}
+		GDALClose(hOutDS);
+		vsTiffFiles.push_back(sTiffFileName);
+	}
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                       CreateDecodedSourceFile()                      */
+/************************************************************************/
+
+/**
+ * \brief Create the warp source from the shared decoded blocks of the granule.
+ *
+ * This method is used to replace the full copy of the coverage which was
+ * decoded by each request. The coverage is divided into blocks of 512x512
+ * pixels, only the blocks intersecting the requested windows (with a one
+ * block margin for interpolation) are needed, see GetSourceWindows(). A
+ * request crossing the antimeridian needs the blocks of the two edges of a
+ * global coverage only. The blocks are decoded once
+ * into uncompressed GeoTIFF files of a single 512x512 tile in the "blocks" directory of the cache,
+ * under the lock of the granule, so the concurrent requests with overlapping windows wait
+ * for the blocks being decoded and only decode the missing ones. Then a
+ * VRT dataset of the full coverage with the needed blocks is created as
+ * the source of gdalwarp. The blocks are pinned until the warp is done,
+ * the least recently used blocks beyond BLOCK_CACHE_MAX_SIZE are only
+ * removed when no request is reading them.
+ *
+ * The number of decoded and shared blocks are accumulated in
+ * "read_scheduler.stats" of the cache directory.
+ *
+ * @param sVRTFileName The path of the VRT dataset to be created.
+ *
+ * @param bSubset Whether the window is limited by the bounding box.
+ *
+ * @param dfMinX The minimum X of the window, in the CRS of the request.
+ *
+ * @param dfMinY The minimum Y of the window.
+ *
+ * @param dfMaxX The maximum X of the window.
+ *
+ * @param dfMaxY The maximum Y of the window.
+ *
+ * @return CE_None on success or CE_Failure if the cache is not available.
+ */
+
+CPLErr WCS_GetCoverage::CreateDecodedSourceFile(const string& sVRTFileName, int bSubset,
+		double dfMinX, double dfMinY, double dfMaxX, double dfMaxY)
+{
+	const int nBlockSize = 512;
+
+	GDALDataset* poSrcDS = (GDALDataset*)mp_AbsDS->GetGDALDataset();
+	string sCacheDir = mp_Conf->Get_CACHE_DIRECTORY();
+	WCS_Cache oCache(sCacheDir, WCS_Cache::GetSizeFromMB(mp_Conf->Get_CACHE_MAX_SIZE(), 1024),
+			WCS_Cache::GetSeconds(mp_Conf->Get_CACHE_LOCK_TIMEOUT(), 300));
+	string sSource = GetSourceIdentity();
+	if (!poSrcDS || poSrcDS->GetRasterCount() < 1 || EQUAL(sSource.c_str(), "") || !oCache.IsEnabled())
+		return CE_Failure;
+
+	//The blocks have their own directory and budget, out of the reach of the evictions of the results
+	string sBlockDir = CPLFormFilename(sCacheDir.c_str(), "blocks", NULL);
+	mp_BlockCache.reset(new WCS_Cache(sBlockDir, WCS_Cache::GetSizeFromMB(mp_Conf->Get_BLOCK_CACHE_MAX_SIZE(), 1024)));
+	if (!mp_BlockCache->IsEnabled())
+		return CE_Failure;
+
+	int nXSize = poSrcDS->GetRasterXSize();
+	int nYSize = poSrcDS->GetRasterYSize();
+	int nBands = poSrcDS->GetRasterCount();
+	GDALDataType eDataType = poSrcDS->GetRasterBand(1)->GetRasterDataType();
+
+	string sGranule = "decoded\ncoverage=" + ms_CovGDALID + "\nsource=" + sSource + "\nbands=";
+	for (size_t i = 0; i < mvi_BandList.size(); i++)
+		sGranule += convertToString(mvi_BandList[i]) + ",";
+	string sGranuleKey = oCache.GetKey(sGranule);
+
+	//The windows of the request in pixels, the whole coverage if it could not be located, and
+	//one window on each side of the antimeridian if the request crosses it
+	vector<int> anWindows;
+	GetSourceWindows(bSubset, dfMinX, dfMinY, dfMaxX, dfMaxY, nBlockSize, anWindows);
+	double adfGeoTransform[6];
+
+	//Decode the missing blocks under the lock of the granule, the blocks are immutable once renamed.
+	//The window is copied without the shared blocks if the lock is not granted in time.
+	if (CE_None != oCache.Lock(sGranule))
+		return CE_Failure;
+	int nDecoded = 0, nShared = 0;
+	int nPid = (int)getpid();
+	void* pBuffer = CPLMalloc(nBlockSize * nBlockSize * GDALGetDataTypeSize(eDataType) / 8);
+	GDALDriver* poGTiffDriver = (GDALDriver*) GDALGetDriverByName("GTiff");
+
+	//Each block file is a single tile, so that gdalwarp reads it as one chunk
+	char** papszBlockOptions = NULL;
+	papszBlockOptions = CSLSetNameValue(papszBlockOptions, "TILED", "YES");
+	papszBlockOptions = CSLSetNameValue(papszBlockOptions, "BLOCKXSIZE", convertToString(nBlockSize).c_str());
+	papszBlockOptions = CSLSetNameValue(papszBlockOptions, "BLOCKYSIZE", convertToString(nBlockSize).c_str());
+	vector<string> vBlockFiles;
+	vector<int> vBlockXY;
+	set<pair<int, int> > oBlocks;
+	CPLErr eErr = CE_None;
+	for (size_t iWindow = 0; iWindow + 3 < anWindows.size() && eErr == CE_None; iWindow += 4)
+	{
+		int nX0 = anWindows[iWindow], nY0 = anWindows[iWindow + 1];
+		int nX1 = anWindows[iWindow + 2], nY1 = anWindows[iWindow + 3];
+		for (int nBY = nY0 / nBlockSize; nBY <= (nY1 - 1) / nBlockSize && eErr == CE_None; nBY++)
+		{
+			for (int nBX = nX0 / nBlockSize; nBX <= (nX1 - 1) / nBlockSize && eErr == CE_None; nBX++)
+			{
+				//The windows on each side of the antimeridian could share blocks
+				if (!oBlocks.insert(make_pair(nBX, nBY)).second)
+					continue;
+
+				string sBlockName = sGranuleKey + "_" + convertToString(nBX) + "_" + convertToString(nBY) + ".blk.tif";
+				string sBlockFileName = CPLFormFilename(sBlockDir.c_str(), sBlockName.c_str(), NULL);
+				vBlockFiles.push_back(sBlockFileName);
+				vBlockXY.push_back(nBX);
+				vBlockXY.push_back(nBY);
+
+				if (mp_BlockCache->Pin(sBlockFileName))
+				{
+					utime(sBlockFileName.c_str(), NULL);
+					nShared++;
+					continue;
+				}
+
+				int nXOff = nBX * nBlockSize, nYOff = nBY * nBlockSize;
+				int nW = MIN(nBlockSize, nXSize - nXOff), nH = MIN(nBlockSize, nYSize - nYOff);
+				string sTmpFileName = sBlockFileName + "." + convertToString(nPid) + ".tmp";
+				GDALDataset* poBlockDS = poGTiffDriver ?
+						poGTiffDriver->Create(sTmpFileName.c_str(), nW, nH, nBands, eDataType, papszBlockOptions) : NULL;
+				if (!poBlockDS)
+				{
+					eErr = CE_Failure;
+					break;
+				}
+				for (int iBand = 1; iBand <= nBands && eErr == CE_None; iBand++)
+				{
+					eErr = poSrcDS->GetRasterBand(iBand)->RasterIO(GF_Read, nXOff, nYOff, nW, nH, pBuffer, nW, nH, eDataType, 0, 0);
+					if (eErr == CE_None)
+						eErr = poBlockDS->GetRasterBand(iBand)->RasterIO(GF_Write, 0, 0, nW, nH, pBuffer, nW, nH, eDataType, 0, 0);
+				}
+				GDALClose(poBlockDS);
+				if (eErr != CE_None || !mp_BlockCache->Pin(sTmpFileName) ||
+					rename(sTmpFileName.c_str(), sBlockFileName.c_str()) != 0)
+				{
+					unlink(sTmpFileName.c_str());
+					eErr = CE_Failure;
+					break;
+				}
+				nDecoded++;
+			}
+		}
+	}
+	CPLFree(pBuffer);
+	CSLDestroy(papszBlockOptions);
+	oCache.Unlock();
+	if (eErr != CE_None)
+		return CE_Failure;
+
+	//The VRT dataset keeps the georeference of the coverage, the blocks outside the window are left empty
+	GDALDriver* poVRTDriver = (GDALDriver*) GDALGetDriverByName("VRT");
+	VRTDataset* poVDS = poVRTDriver ?
+			(VRTDataset*) poVRTDriver->Create(sVRTFileName.c_str(), nXSize, nYSize, 0, eDataType, NULL) : NULL;
+	if (!poVDS)
+		return CE_Failure;
+
+	if (CE_None == poSrcDS->GetGeoTransform(adfGeoTransform))
+		poVDS->SetGeoTransform(adfGeoTransform);
+	poVDS->SetProjection(poSrcDS->GetProjectionRef());
+	if (poSrcDS->GetGCPCount() > 0)
+		poVDS->SetGCPs(poSrcDS->GetGCPCount(), poSrcDS->GetGCPs(), poSrcDS->GetGCPProjection());
+	if (poSrcDS->GetMetadata("GEOLOCATION"))
+		poVDS->SetMetadata(poSrcDS->GetMetadata("GEOLOCATION"), "GEOLOCATION");
+
+	for (int iBand = 1; iBand <= nBands; iBand++)
+	{
+		poVDS->AddBand(eDataType, NULL);
+		VRTSourcedRasterBand* poVRTBand = (VRTSourcedRasterBand*) poVDS->GetRasterBand(iBand);
+		int bHasNoData = FALSE;
+		double dfNoData = poSrcDS->GetRasterBand(iBand)->GetNoDataValue(&bHasNoData);
+		poVRTBand->SetNoDataValue(bHasNoData ? dfNoData : mp_AbsDS->GetMissingValue());
+		for (size_t i = 0; i < vBlockFiles.size(); i++)
+		{
+			int nXOff = vBlockXY[2 * i] * nBlockSize, nYOff = vBlockXY[2 * i + 1] * nBlockSize;
+			int nW = MIN(nBlockSize, nXSize - nXOff), nH = MIN(nBlockSize, nYSize - nYOff);
+			poVRTBand->AddSimpleSource(vBlockFiles[i].c_str(), iBand, 0, 0, nW, nH, nXOff, nYOff, nW, nH);
+		}
+	}
+	GDALClose(poVDS);
+
+	//Counters of the saved decode work, skipped if the lock is not granted in time
+	if (CE_None == oCache.Lock("read_scheduler.stats"))
+	{
+		string sStatsFileName = CPLFormFilename(sCacheDir.c_str(), "read_scheduler.stats", NULL);
+		GIntBig nTotalDecoded = 0, nTotalShared = 0;
+		string sName;
+		ifstream statsIn(sStatsFileName.c_str());
+		while (statsIn >> sName)
+		{
+			if (sName == "decoded_blocks")
+				statsIn >> nTotalDecoded;
+			else if (sName == "shared_blocks")
+				statsIn >> nTotalShared;
+		}
+		statsIn.close();
+		ofstream statsOut(sStatsFileName.c_str());
+		statsOut << "decoded_blocks " << nTotalDecoded + nDecoded << endl;
+		statsOut << "shared_blocks " << nTotalShared + nShared << endl;
+		statsOut.close();
+		oCache.Unlock();
+	}
+
+	//The blocks are trimmed after gdalwarp has read them, see CreateOutputFile()
+	return CE_None;
+}
+
+/************************************************************************/
+/*                           WCST_Respond()                             */
+/************************************************************************/
+
+/**
+ * \brief The enter point for WCS_GetCoverage class (Command line environment).
+ *
+ * This method is the enter point for WCS_GetCoverage class, which
  * is used under command line environment. In order to debug WCS and use
  * WCS as a command line, the user could issue a request under command line.
  * The response information will be stored in the specified file.
@@ -1537,6 +3742,69 @@ void WCS_GetCoverage::WCST_Respond()
 		return;
 	}
 
+	//The full coverage in native CRS and format, deliver the source file as is
+	if (IsPassthroughRequest())
+	{
+		if (CE_None != HttpPassthroughRespond())
+		{
+			SendHttpHead();
+			cout << GetWCS_ErrorMsg() << endl;
+		}
+		return;
+	}
+
+	//Serve the identical request from the result cache, only the direct response is cached
+	WCS_Cache oCache(mp_Conf->Get_CACHE_DIRECTORY(), WCS_Cache::GetSizeFromMB(mp_Conf->Get_CACHE_MAX_SIZE(), 1024),
+			WCS_Cache::GetSeconds(mp_Conf->Get_CACHE_LOCK_TIMEOUT(), 300));
+	string sCanonicalRequest;
+	if (!mb_IsStore && !mb_MultiPart && !EQUAL(ms_OutputFormatCode.c_str(), "JPIP") && oCache.IsEnabled())
+		sCanonicalRequest = GetCanonicalRequest();
+
+	string sSuffix = CPLGetExtension(sOutFileName.c_str());
+	sSuffix = "." + sSuffix;
+	string sCachedFileName;
+	int bCached = !sCanonicalRequest.empty() && oCache.Lookup(sCanonicalRequest, sSuffix, sCachedFileName);
+	if (!sCanonicalRequest.empty() && !bCached)
+	{
+		//Single flight: the identical concurrent requests wait for the first one and are served by its output,
+		//or compute it without the cache if the first one does not finish in time
+		if (CE_None == oCache.Lock(sCanonicalRequest))
+			bCached = oCache.Lookup(sCanonicalRequest, sSuffix, sCachedFileName);
+		else
+			sCanonicalRequest = "";
+	}
+	if (bCached)
+	{
+		oCache.Unlock();
+
+		string sETag = "\"" + oCache.GetKey(sCanonicalRequest) + "\"";
+		const char* pszIfNoneMatch = getenv("HTTP_IF_NONE_MATCH");
+		if (pszIfNoneMatch && StrTrim(pszIfNoneMatch) == sETag)
+		{
+			vector<string> head;
+			head.push_back("Status: 304 Not Modified\r\n");
+			head.push_back("ETag: " + sETag + "\r\n\r\n");
+			HttpWriteBlocks(head);
+			return;
+		}
+
+		//Delivered under the name of the output it was stored from, as on a miss
+		string sStoredName = oCache.GetStoredName(sCanonicalRequest);
+		string sContentType = ms_OutputContentType;
+		sContentType += "\r\nContent-Disposition: attachment; filename=";
+		sContentType += sStoredName.empty() ? CPLGetFilename(sCachedFileName.c_str()) : sStoredName;
+
+		const char* pszRange = getenv("HTTP_RANGE");
+		const char* pszIfRange = getenv("HTTP_IF_RANGE");
+		if (CE_None != HttpSendFile(sCachedFileName, sContentType, pszRange ? pszRange : "",
+				sETag, pszIfRange ? pszIfRange : ""))
+		{
+			SendHttpHead();
+			cout << GetWCS_ErrorMsg() << endl;
+		}
+		return;
+	}
+
 	if (CE_None != CreateOutputFile(sOutFileName))
 	{
 		SendHttpHead();
@@ -1554,6 +3822,9 @@ void WCS_GetCoverage::WCST_Respond()
 	}
 	else
 	{
+		if (!sCanonicalRequest.empty())
+			oCache.Store(sCanonicalRequest, sSuffix, sOutFileName);
+		oCache.Unlock();
 		HttpDirectoryRespond(sOutFileName);
 		unlink(sOutFileName.c_str());
 	}
@@ -36,6 +36,7 @@
 #include <fcntl.h>
 
 #include "WCS_T.h"
+#include "WCS_Cache.h"
 
 /* ******************************************************************** */
 /*                          WCS_DescribeCoverage                        */
@@ -69,6 +70,9 @@ protected:
 	string ms_RequestBeginTime;	//2010-06-06T12:12:12Z
 	string ms_RequestEndTime;	//2010-06-06T12:12:12Z
 	string ms_Interpolation;	//nearest&bilinea&cubic&
+	string ms_Compression;		//geotiff:compression=Deflate, empty for configured default
+	string ms_CompressionLevel;	//geotiff:compressionLevel=6
+	string ms_Predictor;		//geotiff:predictor=Horizontal, empty for chosen by data type
 
 	int mb_IsStore;				//Return XML which include the URL for output file
 	int mb_SubsetSpatial;		//Does user specify spatial subset?
@@ -77,25 +81,73 @@ protected:
 	OGRSpatialReference mo_NativeCRS;
 	OGRSpatialReference mo_RequestedCRS;
 	OGRSpatialReference mo_ResponseCRS;
+	const RegisteredCRS* mp_RequestedRegCRS;	//Registered CRS of the request and response, with their
+	const RegisteredCRS* mp_ResponseRegCRS;		//precomputed flags, NULL if not parsed from the registry
 
 	vector<int> mvi_BandList;
 	double md_OutGeoTransform[6];
 
 	GDALResampleAlg me_Interplation;
 
+	string ms_TileGridKey;		//Hash identifying the tile grid of the coverage
+	string ms_TileCRS_URN;		//CRS of the tiles, empty for native CRS
+	double md_TileSize;			//Size of the tiles, in degrees
+	int mi_TilePixels;			//Width and height of the tiles, in pixels
+	int mi_TileMinX;			//Range of the tiles intersecting the request
+	int mi_TileMinY;
+	int mi_TileMaxX;
+	int mi_TileMaxY;
+	auto_ptr<WCS_Cache> mp_TileCache;	//Tile store, pins the tiles of the request until they are cut
+	auto_ptr<WCS_Cache> mp_BlockCache;	//Decoded blocks, pins the blocks of the request until they are warped
+
 protected:
 	string CreateOutputFileSuffix();
 	CPLErr CreateISO19115Metadata(DatasetObject dsObj);
 	CPLErr CreateEOMetadata(const string& sOutFileName);
 	CPLErr GetCoverageInitial();
 	CPLErr SetCRSFromURN(OGRSpatialReference& crs_ID, const char* CRS_urn);
-	CPLErr CreateBinaryFile(const string& sOutFileName);
+	CPLErr CreateBinaryFile(const string& sSourceFile, const string& sOutFileName);
     CPLErr CreateHDFEOS2File(const string& sSourceFile, string hdfeosFile);
 	CPLErr CreateOutputFile(const string& sOutFileName);
+	char** GetGTiffCreationOptions(int bCompress = FALSE);
+	string GetGTiffCreationCmdOptions();
+	char** GetCOGCreationOptions();
+	char** GetJP2CreationOptions();
+	char** GetOutputCreationOptions();
+	string GetCanonicalRequest();
+	string GetCanonicalWarpRequest();
+	string GetSourceIdentity();
+	int IsGeographicCRS(const RegisteredCRS* poRegCRS, const OGRSpatialReference& oCRS);
+	int IsTileGridRequest();
+	int IsTileGridCached();
+	string GetTileFileName(int nTileX, int nTileY);
+	CPLErr CreateTileGridWarpFile(const string& sSrcName, const string& sWarpFileName,
+			const string& sWarpCmdBase, const string& sTiffCmdOptions);
+	int IsAntimeridianRequest();
+	CPLErr CreateAntimeridianWarpFile(const string& sSrcName, const string& sWarpFileName,
+			const string& sWarpCmd, const string& sTiffCmdOptions);
+	int IsOutputTooLarge(int nWidth, int nHeight);
+	int IsSwathCoverage();
+	int HasSwathGeolocationArrays();
+	int IsSwathNearestRequest();
+	CPLErr CreateSwathNearestWarpFile(const string& sWarpFileName, char** papszTiffOptions);
+	CPLErr CreateSwathRangeSources(const string& sOutFileName, int bTileGrid, vector<string>& vsSourceFiles);
+	CPLErr GetGeolocationRanges(GDALRasterBand* poXBand, GDALRasterBand* poYBand,
+			double dfLineOffset, double dfLineStep, int nLines,
+			double dfMinX, double dfMinY, double dfMaxX, double dfMaxY, vector<int>& anRanges);
+	void GetSourceWindows(int bSubset, double dfMinX, double dfMinY, double dfMaxX, double dfMaxY,
+			int nMargin, vector<int>& anWindows);
+	CPLErr CreateWindowSourceFile(const string& sTiffPrefix, int bSubset,
+			double dfMinX, double dfMinY, double dfMaxX, double dfMaxY, char** papszTiffOptions,
+			vector<string>& vsTiffFiles);
+	CPLErr CreateDecodedSourceFile(const string& sVRTFileName, int bSubset,
+			double dfMinX, double dfMinY, double dfMaxX, double dfMaxY);
 	CPLErr SetOutputResolution();
 	CPLErr HttpDirectoryRespond(const string& sOutFileName);
 	CPLErr HttpStoreRespond(const string& sOutFileName);
 	CPLErr HttpMultiPartsDirectoryRespond(const string& sOutFileName);
+	int IsPassthroughRequest();
+	CPLErr HttpPassthroughRespond();
 	CPLErr ExeCommand(string logFilePath, string cmd);
 
 public:
@@ -0,0 +1,268 @@
+/******************************************************************************
+ * $Id: WCS_GetStoredCoverage.cpp $
+ *
+ * Project:  The Open Geospatial Consortium (OGC) Web Coverage Service (WCS)
+ * 			 for Earth Observation: Open Source Reference Implementation
+ * Purpose:  WCS_GetStoredCoverage class implementation
+ * Author:   Yuanzheng Shao, yshao3@gmu.edu
+ *
+ ******************************************************************************
+ * Copyright (c) 2011, Liping Di <ldi@gmu.edu>, Yuanzheng Shao <yshao3@gmu.edu>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "WCS_GetStoredCoverage.h"
+
+/************************************************************************/
+/* ==================================================================== */
+/*                        WCS_GetStoredCoverage                         */
+/* ==================================================================== */
+/************************************************************************/
+
+/**
+ * \class WCS_GetStoredCoverage "WCS_GetStoredCoverage.h"
+ *
+ * This class is used to deliver the output of a GetCoverage request with
+ * "store=true", which is kept in the temporary output directory. The
+ * request looks like:
+ * @code
+ * service=WCS&version=2.0.0&request=GetStoredCoverage&storedId=<file name>
+ * @endcode
+ *
+ * The output is delivered with HTTP Range, If-Range and multiple ranges
+ * support, and a strong ETag computed from the content when it was stored,
+ * so that the download of large outputs could be resumed.
+ */
+
+WCS_GetStoredCoverage::WCS_GetStoredCoverage()
+{
+}
+
+/************************************************************************/
+/*                       WCS_GetStoredCoverage()                        */
+/************************************************************************/
+
+/**
+ * \brief Constructor of a WCS_GetStoredCoverage object.
+ *
+ * This is the accepted method of creating an WCS_GetStoredCoverage object.
+ *
+ * @param conf String of the full path of the configuration file.
+ */
+
+WCS_GetStoredCoverage::WCS_GetStoredCoverage(const string& conf) :
+		WCS_T(conf)
+{
+	mb_SoapRequest = 0;
+	ms_StoredID = "";
+	ms_StoredFileName = "";
+}
+
+WCS_GetStoredCoverage::~WCS_GetStoredCoverage()
+{
+
+}
+
+/************************************************************************/
+/*                    GetReqMessageFromURLString()                      */
+/************************************************************************/
+
+/**
+ * \brief Fetch the request parameters from URL string.
+ *
+ * This method is used to fetch the GetStoredCoverage parameters from an URL
+ * string (HTTP GET method). The stored identifier should be a plain file
+ * name, which is resolved in the temporary output directory.
+ *
+ * @param urlStr String of the GetStoredCoverage request.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr WCS_GetStoredCoverage::GetReqMessageFromURLString(const string& urlStr)
+{
+	KVPsReader kvps(urlStr, '&');
+
+	ms_StoredID = kvps.getValue("STOREDID", "");
+	if (ms_StoredID == "")
+	{
+		SetWCS_ErrorLocator("STOREDID");
+		WCS_Error(CE_Failure, OGC_WCS_MissingParameterValue, "No Stored Coverage Identifier.");
+		return CE_Failure;
+	}
+
+	if (ms_StoredID.find("/") != string::npos || ms_StoredID[0] == '.')
+	{
+		SetWCS_ErrorLocator("STOREDID");
+		WCS_Error(CE_Failure, OGC_WCS_InvalidParameterValue, "Invalid Stored Coverage Identifier.");
+		return CE_Failure;
+	}
+
+	string dir = mp_Conf->Get_TEMPORARY_OUTPUT_DIRECTORY();
+	if (!dir.empty() && dir[dir.length() - 1] != '/')
+		dir += "/";
+	ms_StoredFileName = dir + ms_StoredID;
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                           WCST_Respond()                             */
+/************************************************************************/
+
+/**
+ * \brief The enter point for WCS_GetStoredCoverage class (Command line environment).
+ *
+ * Under command line environment, the path of the stored output is returned.
+ *
+ * @param sOutFileName The path of the stored output.
+ */
+
+void WCS_GetStoredCoverage::WCST_Respond(string& sOutFileName)
+{
+	sOutFileName = ms_StoredFileName;
+}
+
+/************************************************************************/
+/*                           WCST_Respond()                             */
+/************************************************************************/
+
+/**
+ * \brief The enter point for WCS_GetStoredCoverage class (CGI environment).
+ *
+ * This method will deliver the stored output to user. The HTTP Range and
+ * If-Range headers are honored, and the ETag of the output is delivered.
+ * If the If-None-Match header matches the ETag, "304 Not Modified" is
+ * delivered without content.
+ */
+
+void WCS_GetStoredCoverage::WCST_Respond()
+{
+	string sETag, sContentType;
+	if (CE_None != WCSTReadStoredCoverageTag(ms_StoredFileName, sETag, sContentType))
+	{
+		SendHttpHead();
+		cout << GetWCS_ErrorMsg() << endl;
+		return;
+	}
+
+	const char* pszIfNoneMatch = getenv("HTTP_IF_NONE_MATCH");
+	if (pszIfNoneMatch && (StrTrim(pszIfNoneMatch) == sETag || StrTrim(pszIfNoneMatch) == "*"))
+	{
+		vector<string> head;
+		head.push_back("Status: 304 Not Modified\r\n");
+		head.push_back("ETag: " + sETag + "\r\n\r\n");
+		HttpWriteBlocks(head);
+		return;
+	}
+
+	sContentType += "\r\nContent-Disposition: attachment; filename=";
+	sContentType += ms_StoredID;
+
+	const char* pszRange = getenv("HTTP_RANGE");
+	const char* pszIfRange = getenv("HTTP_IF_RANGE");
+	if (CE_None != HttpSendFile(ms_StoredFileName, sContentType, pszRange ? pszRange : "",
+			sETag, pszIfRange ? pszIfRange : ""))
+	{
+		SendHttpHead();
+		cout << GetWCS_ErrorMsg() << endl;
+	}
+
+	return;
+}
+
+/************************************************************************/
+/*                      WCSTWriteStoredCoverageTag()                    */
+/************************************************************************/
+
+/**
+ * \brief Record the entity tag and content type of a stored output.
+ *
+ * This method will compute the content hash of a stored output, and write
+ * it as strong ETag, together with the content type header, to the sidecar
+ * file "<output>.etag". Only the outputs with the sidecar file could be
+ * delivered by GetStoredCoverage request.
+ *
+ * @param sOutFileName The path of the stored output.
+ *
+ * @param sContentType The content type header of the output, such as
+ * "Content-Type: image/tiff".
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr WCSTWriteStoredCoverageTag(const string& sOutFileName, const string& sContentType)
+{
+	string sHash = GetFileContentHash(sOutFileName);
+	if (sHash.empty())
+	{
+		SetWCS_ErrorLocator("WCSTWriteStoredCoverageTag()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to read the stored output file.");
+		return CE_Failure;
+	}
+
+	string sTagFileName = sOutFileName + ".etag";
+	ofstream ofs(sTagFileName.c_str());
+	if (!ofs)
+	{
+		SetWCS_ErrorLocator("WCSTWriteStoredCoverageTag()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to write the tag file of stored output.");
+		return CE_Failure;
+	}
+	ofs << "\"" << sHash << "\"" << endl;
+	ofs << sContentType << endl;
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                      WCSTReadStoredCoverageTag()                     */
+/************************************************************************/
+
+/**
+ * \brief Fetch the entity tag and content type of a stored output.
+ *
+ * This method will read the sidecar file written by
+ * WCSTWriteStoredCoverageTag().
+ *
+ * @param sOutFileName The path of the stored output.
+ *
+ * @param sETag The string used to place the ETag (with quotes).
+ *
+ * @param sContentType The string used to place the content type header.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr WCSTReadStoredCoverageTag(const string& sOutFileName, string& sETag, string& sContentType)
+{
+	string sTagFileName = sOutFileName + ".etag";
+	ifstream ifs(sTagFileName.c_str());
+	if (!ifs || !getline(ifs, sETag) || !getline(ifs, sContentType) ||
+		sETag.empty() || GetFileByteSize(sOutFileName) < 0)
+	{
+		SetWCS_ErrorLocator("WCSTReadStoredCoverageTag()");
+		WCS_Error(CE_Failure, OGC_WCS_NoSuchCoverage, "The stored coverage does not exist or has expired.");
+		return CE_Failure;
+	}
+
+	return CE_None;
+}
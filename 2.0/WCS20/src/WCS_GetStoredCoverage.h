@@ -0,0 +1,66 @@
+/******************************************************************************
+ * $Id: WCS_GetStoredCoverage.h $
+ *
+ * Project:  The Open Geospatial Consortium (OGC) Web Coverage Service (WCS)
+ * 			 for Earth Observation: Open Source Reference Implementation
+ * Purpose:  WCS_GetStoredCoverage class definition
+ * Author:   Yuanzheng Shao, yshao3@gmu.edu
+ *
+ ******************************************************************************
+ * Copyright (c) 2011, Liping Di <ldi@gmu.edu>, Yuanzheng Shao <yshao3@gmu.edu>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef WCS_GETSTOREDCOVERAGE_H_
+#define WCS_GETSTOREDCOVERAGE_H_
+
+#include "WCS_T.h"
+
+/* ******************************************************************** */
+/*                         WCS_GetStoredCoverage                        */
+/* ******************************************************************** */
+
+//! This class is used to deliver the stored output of GetCoverage request.
+
+class WCS_GetStoredCoverage: public WCS_T
+{
+protected:
+	string ms_StoredID;			//File name of the stored output
+	string ms_StoredFileName;	//Full path of the stored output
+
+public:
+	WCS_GetStoredCoverage();
+	WCS_GetStoredCoverage(const string& conf);
+	virtual ~WCS_GetStoredCoverage();
+
+	virtual CPLErr GetReqMessageFromURLString(const string&);
+
+	virtual void WCST_Respond(string& sOutFileName);
+	virtual void WCST_Respond();
+};
+
+CPL_C_START
+
+CPLErr WCSTWriteStoredCoverageTag(const string& sOutFileName, const string& sContentType);
+CPLErr WCSTReadStoredCoverageTag(const string& sOutFileName, string& sETag, string& sContentType);
+
+CPL_C_END
+
+#endif /* WCS_GETSTOREDCOVERAGE_H_ */
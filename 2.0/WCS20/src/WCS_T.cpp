@@ -32,6 +32,7 @@
 #include "WCS_GetCapabilities.h"
 #include "WCS_DescribeCoverage.h"
 #include "WCS_GetCoverage.h"
+#include "WCS_GetStoredCoverage.h"
 #include "wcstdsinc.h"
 
 
@@ -75,6 +76,11 @@ WCS_T::WCS_T(const string& conf):mp_Conf(new WCS_Configure(conf))
 	ms_datasetSeriesConfPath = mp_Conf->Get_DATASET_SERIES_CONFIGRATION_FILE_PATH();
 	ms_dataDirectoryPath = mp_Conf->Get_WCS_SERVICE_DATA_DIRECTORY();
 
+	//The swath datasets of the library find their geolocation sidecar files with it
+	string sGeolCacheDir = mp_Conf->Get_GEOLOCATION_CACHE_DIRECTORY();
+	if (!EQUAL(sGeolCacheDir.c_str(), ""))
+		CPLSetConfigOption("WCS_GEOLOCATION_CACHE", sGeolCacheDir.c_str());
+
 	ifstream ifile(mp_Conf->Get_ISO_19115_METADATA_TEMPLATE_PATH().c_str());
 	ostringstream out;
 	out << ifile.rdbuf();
@@ -709,6 +715,15 @@ WCS_T* WCSTOpenFromURLString(string urlStr, const string& cnfNm)
 			return NULL;
 		}
 	}
+	else if (EQUAL(sRequest.c_str(),"GETSTOREDCOVERAGE"))
+	{
+		wcst = new WCS_GetStoredCoverage(cnfNm);
+		if (CE_None != wcst->GetReqMessageFromURLString(urlStr))
+		{
+			delete wcst;
+			return NULL;
+		}
+	}
 	else
 	{
 		SetWCS_ErrorLocator("WCS-GET-KVP");
@@ -29,6 +29,14 @@
  * DEALINGS IN THE SOFTWARE.
  ****************************************************************************/
 
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cpl_multiproc.h>
 #include "AbstractDataset.h"
 
 /************************************************************************/
@@ -52,7 +60,8 @@
 /************************************************************************/
 /*                            AbstractDataset()                         */
 /************************************************************************/
-AbstractDataset::AbstractDataset()
+AbstractDataset::AbstractDataset() :
+	mb_IsWholeFile(FALSE), mi_GeolGCPCount(0), mp_GeolGCPs(NULL), mp_GeolMap(NULL), mn_GeolMapSize(0)
 {
 }
 
@@ -68,7 +77,8 @@ AbstractDataset::AbstractDataset()
  */
 
 AbstractDataset::AbstractDataset(const string& id, vector<int> &rBandList) :
-	ms_CoverageID(id), mv_BandList(rBandList)
+	ms_CoverageID(id), mv_BandList(rBandList), mb_IsWholeFile(FALSE),
+	mi_GeolGCPCount(0), mp_GeolGCPs(NULL), mp_GeolMap(NULL), mn_GeolMapSize(0)
 {
 }
 
@@ -87,6 +97,8 @@ AbstractDataset::~AbstractDataset()
 {
 	if (maptrDS.get())
 		GDALClose(maptrDS.release());
+	if (mp_GeolMap)
+		munmap(mp_GeolMap, mn_GeolMapSize);
 }
 
 /************************************************************************/
@@ -186,8 +198,8 @@ const OGRSpatialReference& AbstractDataset::GetNativeCRS()
 
 CPLErr AbstractDataset::SetNativeCRS()
 {
-	char* wktStr = (char*) maptrDS->GetProjectionRef();
-	if (wktStr && OGRERR_NONE == mo_NativeCRS.importFromWkt(&wktStr))
+	const char* wktStr = maptrDS->GetProjectionRef();
+	if (wktStr && *wktStr != '\0' && OGRERR_NONE == ImportRegisteredCRS(mo_NativeCRS, wktStr))
 		return CE_None;
 
 	return CE_Failure;
@@ -431,6 +443,26 @@ int AbstractDataset::IsbGeoTransformSet()
 	return mb_GeoTransformSet;
 }
 
+/************************************************************************/
+/*                           IsWholeFileCoverage()                      */
+/************************************************************************/
+
+/**
+ * \brief Determine whether the coverage is the whole source file.
+ *
+ * The method will return whether the coverage is stored as the whole
+ * source file in its native format, i.e. the source file is not a container
+ * of other sub-datasets. For such coverage, a request for the full coverage
+ * in native CRS and format could be answered with the source file itself.
+ *
+ * @return TRUE if the coverage is the whole source file, otherwise FALSE.
+ */
+
+int AbstractDataset::IsWholeFileCoverage()
+{
+	return mb_IsWholeFile;
+}
+
 /************************************************************************/
 /*                            GetNativeBBox()                           */
 /************************************************************************/
@@ -970,6 +1002,748 @@ string AbstractDataset::GetGeoCRS_URN()
 	return urn;
 }
 
+/************************************************************************/
+/*                        LoadGeolocationSidecar()                      */
+/************************************************************************/
+
+/**
+ * \brief Load the geolocation of the swath coverage from its sidecar file.
+ *
+ * Decoding the Latitude/Longitude fields of a swath granule into GCPs is
+ * the most expensive part of opening it, so the decoded GCPs, their corner
+ * points and the footprint of the swath are persisted into a sidecar file
+ * in the directory given by the WCS_GEOLOCATION_CACHE configuration option.
+ * The sidecar is keyed by the coverage identifier, the size and the
+ * modification time of the granule, and the GEOL_AS_GCPS mode. It is
+ * mapped into memory, the GCPs are read from the mapping in place.
+ *
+ * The layout of the sidecar, in the byte order of the server:
+ *
+ *   0  char[8]   magic, "WCSGEOL1"
+ *   8  int32     number of GCPs
+ *  12  int32     length of the GCP projection WKT, including the terminating zero
+ *  16  double[4] lower-left and upper-right corner points
+ *  48  double[8] footprint, upper-left, upper-right, lower-right and lower-left
+ * 112  double[4] pixel, line, x and y of each GCP
+ *      GCP projection WKT
+ *
+ * @param sMode The GEOL_AS_GCPS mode, FULL or PARTIAL.
+ *
+ * @return TRUE if the geolocation was loaded from the sidecar, FALSE otherwise.
+ * In the latter case, SetGeolocationFromGCPs() should be called once the
+ * dataset is opened with GCPs.
+ */
+
+int AbstractDataset::LoadGeolocationSidecar(const string& sMode)
+{
+	ms_GeolSidecarName = "";
+	const char* pszCacheDir = CPLGetConfigOption("WCS_GEOLOCATION_CACHE", NULL);
+	VSIStatBufL sStat;
+	if (!pszCacheDir || *pszCacheDir == '\0' || VSIStatL(ms_SrcFilename.c_str(), &sStat) != 0)
+		return FALSE;
+
+	if (VSIStatL(pszCacheDir, &sStat) != 0)
+		VSIMkdir(pszCacheDir, 0755);
+	VSIStatL(ms_SrcFilename.c_str(), &sStat);
+	string sKey = ms_CoverageID + "\n" + sMode + "\n" +
+			CPLString().Printf(CPL_FRMT_GIB "\n%ld", (GIntBig)sStat.st_size, (long)sStat.st_mtime);
+	ms_GeolSidecarName = CPLFormFilename(pszCacheDir, GetStringHash(sKey).c_str(), "geol");
+
+	int fd = open(ms_GeolSidecarName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return FALSE;
+	struct stat sFileStat;
+	if (fstat(fd, &sFileStat) != 0 || sFileStat.st_size < 112)
+	{
+		close(fd);
+		return FALSE;
+	}
+	size_t nSize = (size_t)sFileStat.st_size;
+	void* pMap = mmap(NULL, nSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (pMap == MAP_FAILED)
+		return FALSE;
+
+	const char* pabyMap = (const char*) pMap;
+	GInt32 nGCPs, nWKTLength;
+	memcpy(&nGCPs, pabyMap + 8, 4);
+	memcpy(&nWKTLength, pabyMap + 12, 4);
+	if (memcmp(pabyMap, "WCSGEOL1", 8) != 0 || nGCPs < 0 || nWKTLength < 1 ||
+		112 + (size_t)nGCPs * 32 + nWKTLength != nSize || pabyMap[nSize - 1] != '\0')
+	{
+		munmap(pMap, nSize);
+		return FALSE;
+	}
+
+	if (mp_GeolMap)
+		munmap(mp_GeolMap, mn_GeolMapSize);
+	mp_GeolMap = pMap;
+	mn_GeolMapSize = nSize;
+
+	double adfCorners[4];
+	memcpy(adfCorners, pabyMap + 16, 32);
+	memcpy(md_GeolFootprint, pabyMap + 48, 64);
+	mo_GeolLowLeft = My2DPoint(adfCorners[0], adfCorners[1]);
+	mo_GeolUpRight = My2DPoint(adfCorners[2], adfCorners[3]);
+	mi_GeolGCPCount = nGCPs;
+	mp_GeolGCPs = (const double*)(pabyMap + 112);
+	ms_GeolGCPProjection = pabyMap + 112 + (size_t)nGCPs * 32;
+
+	return TRUE;
+}
+
+/************************************************************************/
+/*                        SetGeolocationFromGCPs()                      */
+/************************************************************************/
+
+/**
+ * \brief Set the geolocation of the swath coverage from the GCPs.
+ *
+ * This method is used to derive the corner points and the footprint of
+ * the swath from the GCPs of the opened dataset, and to persist them with
+ * the GCPs into the sidecar file if the geolocation cache is configured.
+ * The sidecar is written to a temporary file then renamed, so that the
+ * concurrent readers never see a partial sidecar.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr AbstractDataset::SetGeolocationFromGCPs()
+{
+	int nGCPs = maptrDS->GetGCPCount();
+	const GDAL_GCP* pGCPList = maptrDS->GetGCPs();
+	const char* pszGCPProjection = maptrDS->GetGCPProjection();
+	ms_GeolGCPProjection = pszGCPProjection ? pszGCPProjection : "";
+	if (nGCPs < 1 || NULL == pGCPList)
+	{
+		mi_GeolGCPCount = 0;
+		return CE_None;
+	}
+
+	GetCornerPoints(pGCPList, nGCPs, mo_GeolLowLeft, mo_GeolUpRight);
+
+	//The footprint is made of the GCPs nearest to the corners of the image
+	int iCorners[4] = {0, 0, 0, 0};
+	for (int i = 1; i < nGCPs; i++)
+	{
+		double dfPixel = pGCPList[i].dfGCPPixel, dfLine = pGCPList[i].dfGCPLine;
+		if (dfPixel + dfLine < pGCPList[iCorners[0]].dfGCPPixel + pGCPList[iCorners[0]].dfGCPLine)
+			iCorners[0] = i;
+		if (dfPixel - dfLine > pGCPList[iCorners[1]].dfGCPPixel - pGCPList[iCorners[1]].dfGCPLine)
+			iCorners[1] = i;
+		if (dfPixel + dfLine > pGCPList[iCorners[2]].dfGCPPixel + pGCPList[iCorners[2]].dfGCPLine)
+			iCorners[2] = i;
+		if (dfLine - dfPixel > pGCPList[iCorners[3]].dfGCPLine - pGCPList[iCorners[3]].dfGCPPixel)
+			iCorners[3] = i;
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		md_GeolFootprint[2 * i] = pGCPList[iCorners[i]].dfGCPX;
+		md_GeolFootprint[2 * i + 1] = pGCPList[iCorners[i]].dfGCPY;
+	}
+	mi_GeolGCPCount = nGCPs;
+
+	if (EQUAL(ms_GeolSidecarName.c_str(), ""))
+		return CE_None;
+
+	vector<double> adfGCPs(4 * (size_t)nGCPs);
+	for (int i = 0; i < nGCPs; i++)
+	{
+		adfGCPs[4 * i] = pGCPList[i].dfGCPPixel;
+		adfGCPs[4 * i + 1] = pGCPList[i].dfGCPLine;
+		adfGCPs[4 * i + 2] = pGCPList[i].dfGCPX;
+		adfGCPs[4 * i + 3] = pGCPList[i].dfGCPY;
+	}
+
+	char abyHeader[112];
+	GInt32 nCount = nGCPs;
+	GInt32 nWKTLength = ms_GeolGCPProjection.length() + 1;
+	double adfCorners[4] = {mo_GeolLowLeft.mi_X, mo_GeolLowLeft.mi_Y, mo_GeolUpRight.mi_X, mo_GeolUpRight.mi_Y};
+	memcpy(abyHeader, "WCSGEOL1", 8);
+	memcpy(abyHeader + 8, &nCount, 4);
+	memcpy(abyHeader + 12, &nWKTLength, 4);
+	memcpy(abyHeader + 16, adfCorners, 32);
+	memcpy(abyHeader + 48, md_GeolFootprint, 64);
+
+	string sTmpName = ms_GeolSidecarName + CPLString().Printf(".%d.tmp", (int)getpid());
+	VSILFILE* fp = VSIFOpenL(sTmpName.c_str(), "wb");
+	if (!fp)
+		return CE_Failure;
+	int bOK = VSIFWriteL(abyHeader, 112, 1, fp) == 1 &&
+			VSIFWriteL(&adfGCPs[0], adfGCPs.size() * sizeof(double), 1, fp) == 1 &&
+			VSIFWriteL(ms_GeolGCPProjection.c_str(), nWKTLength, 1, fp) == 1;
+	VSIFCloseL(fp);
+	if (!bOK || VSIRename(sTmpName.c_str(), ms_GeolSidecarName.c_str()) != 0)
+	{
+		VSIUnlink(sTmpName.c_str());
+		return CE_Failure;
+	}
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                          GetGeolocationGCPs()                        */
+/************************************************************************/
+
+/**
+ * \brief Fetch the geolocation GCPs of the swath.
+ *
+ * The GCPs are read from the geolocation sidecar when it is mapped, or
+ * from the GDAL dataset otherwise.
+ *
+ * @param adfPixel The pixel of each GCP.
+ *
+ * @param adfLine The line of each GCP.
+ *
+ * @param adfX The x coordinate (longitude) of each GCP.
+ *
+ * @param adfY The y coordinate (latitude) of each GCP.
+ *
+ * @return The number of GCPs.
+ */
+
+int AbstractDataset::GetGeolocationGCPs(vector<double>& adfPixel, vector<double>& adfLine,
+		vector<double>& adfX, vector<double>& adfY)
+{
+	int nGCPs = mp_GeolGCPs ? mi_GeolGCPCount : (maptrDS.get() ? maptrDS->GetGCPCount() : 0);
+	const GDAL_GCP* pGCPList = (mp_GeolGCPs || !maptrDS.get()) ? NULL : maptrDS->GetGCPs();
+	if (nGCPs < 1 || (!mp_GeolGCPs && !pGCPList))
+		return 0;
+
+	adfPixel.resize(nGCPs);
+	adfLine.resize(nGCPs);
+	adfX.resize(nGCPs);
+	adfY.resize(nGCPs);
+	for (int i = 0; i < nGCPs; i++)
+	{
+		adfPixel[i] = mp_GeolGCPs ? mp_GeolGCPs[4 * i] : pGCPList[i].dfGCPPixel;
+		adfLine[i] = mp_GeolGCPs ? mp_GeolGCPs[4 * i + 1] : pGCPList[i].dfGCPLine;
+		adfX[i] = mp_GeolGCPs ? mp_GeolGCPs[4 * i + 2] : pGCPList[i].dfGCPX;
+		adfY[i] = mp_GeolGCPs ? mp_GeolGCPs[4 * i + 3] : pGCPList[i].dfGCPY;
+	}
+
+	return nGCPs;
+}
+
+/************************************************************************/
+/*                          GetScanlineRanges()                         */
+/************************************************************************/
+
+/**
+ * \brief Find the scanline ranges of the swath intersecting a bounding box.
+ *
+ * The scanlines are grouped into blocks at least as high as the spacing
+ * between the lines of the GCPs, and the bounding box of each block is
+ * computed from its GCPs, read from the geolocation sidecar when mapped.
+ * The blocks intersecting the requested bounding box, with one block of
+ * margin on each side for the pixels between the GCPs, are merged into
+ * ranges of consecutive scanlines. Blocks spanning more than 180 degrees
+ * of longitude cross the antimeridian, and only their latitudes are tested.
+ *
+ * @param dfMinX The west bound of the request, in the CRS of the GCPs. It
+ * could be greater than the east bound when the request crosses the
+ * antimeridian.
+ *
+ * @param dfMinY The south bound of the request.
+ *
+ * @param dfMaxX The east bound of the request.
+ *
+ * @param dfMaxY The north bound of the request.
+ *
+ * @param anRanges The first scanline and the number of scanlines of each
+ * range, empty if no scanline intersects the request.
+ *
+ * @return CE_None on success or CE_Failure if the swath has no geolocation.
+ */
+
+CPLErr AbstractDataset::GetScanlineRanges(double dfMinX, double dfMinY, double dfMaxX, double dfMaxY, vector<int>& anRanges)
+{
+	anRanges.clear();
+	vector<double> adfPixel, adfLine, adfX, adfY;
+	int nGCPs = GetGeolocationGCPs(adfPixel, adfLine, adfX, adfY);
+	int nLines = maptrDS.get() ? maptrDS->GetRasterYSize() : 0;
+	if (nGCPs < 2 || nLines < 1)
+		return CE_Failure;
+
+	//The blocks are at least as high as the largest gap between the lines of the GCPs
+	vector<double> adfSorted(adfLine);
+	sort(adfSorted.begin(), adfSorted.end());
+	double dfMaxGap = 0;
+	for (int i = 1; i < nGCPs; i++)
+		dfMaxGap = MAX(dfMaxGap, adfSorted[i] - adfSorted[i - 1]);
+	int nBlockLines = MAX(16, (int)ceil(dfMaxGap));
+	int nBlocks = (nLines + nBlockLines - 1) / nBlockLines;
+
+	vector<double> adfBMinX(nBlocks, numeric_limits<double>::max()), adfBMaxX(nBlocks, -numeric_limits<double>::max());
+	vector<double> adfBMinY(nBlocks, numeric_limits<double>::max()), adfBMaxY(nBlocks, -numeric_limits<double>::max());
+	vector<int> abHasGCP(nBlocks, FALSE);
+	for (int i = 0; i < nGCPs; i++)
+	{
+		if (adfX[i] == -999)//invalid geolocation, see GetCornerPoints()
+			continue;
+		int iBlock = MAX(0, MIN(nBlocks - 1, (int)(adfLine[i] / nBlockLines)));
+		adfBMinX[iBlock] = MIN(adfBMinX[iBlock], adfX[i]);
+		adfBMaxX[iBlock] = MAX(adfBMaxX[iBlock], adfX[i]);
+		adfBMinY[iBlock] = MIN(adfBMinY[iBlock], adfY[i]);
+		adfBMaxY[iBlock] = MAX(adfBMaxY[iBlock], adfY[i]);
+		abHasGCP[iBlock] = TRUE;
+	}
+
+	int bCrossRequest = dfMinX > dfMaxX;
+	vector<int> abHit(nBlocks, FALSE);
+	for (int b = 0; b < nBlocks; b++)
+	{
+		if (!abHasGCP[b] || adfBMaxY[b] < dfMinY || adfBMinY[b] > dfMaxY)
+			continue;
+		if (adfBMaxX[b] - adfBMinX[b] > 180.0)
+			abHit[b] = TRUE;
+		else if (bCrossRequest)
+			abHit[b] = adfBMaxX[b] >= dfMinX || adfBMinX[b] <= dfMaxX;
+		else
+			abHit[b] = adfBMaxX[b] >= dfMinX && adfBMinX[b] <= dfMaxX;
+	}
+
+	//One block of margin, which also covers the blocks without GCPs
+	vector<int> abRead(nBlocks, FALSE);
+	for (int b = 0; b < nBlocks; b++)
+		abRead[b] = abHit[b] || (b > 0 && abHit[b - 1]) || (b + 1 < nBlocks && abHit[b + 1]);
+
+	for (int b = 0; b < nBlocks; b++)
+	{
+		if (!abRead[b])
+			continue;
+		int nFirst = b;
+		while (b + 1 < nBlocks && abRead[b + 1])
+			b++;
+		int nStartLine = nFirst * nBlockLines;
+		int nEndLine = MIN(nLines, (b + 1) * nBlockLines);
+		anRanges.push_back(nStartLine);
+		anRanges.push_back(nEndLine - nStartLine);
+	}
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                        ResampleSwathNearest()                        */
+/************************************************************************/
+
+#define SWATH_EARTH_RADIUS 6371007.181	// radius of the authalic sphere, in meters
+
+/* Spherical Lambert azimuthal equal-area projection, centered on the output */
+static int ProjectEqualArea(double dfSinLat0, double dfCosLat0, double dfSinLat, double dfCosLat,
+		double dfSinDLon, double dfCosDLon, float* pfX, float* pfY)
+{
+	double dfDen = 1.0 + dfSinLat0 * dfSinLat + dfCosLat0 * dfCosLat * dfCosDLon;
+	if (dfDen < 1e-6)// antipode of the center
+		return FALSE;
+	double dfK = SWATH_EARTH_RADIUS * sqrt(2.0 / dfDen);
+	*pfX = (float)(dfK * dfCosLat * dfSinDLon);
+	*pfY = (float)(dfK * (dfCosLat0 * dfSinLat - dfSinLat0 * dfCosLat * dfCosDLon));
+	return TRUE;
+}
+
+/* Nearest swath pixel of the output cells of some rows */
+typedef struct
+{
+	const float* pafX;				// projected swath pixels
+	const float* pafY;
+	const int* panBucketStart;		// first pixel of each bucket, and end of the last one
+	const int* panBucketPixel;
+	int nBucketsX;
+	int nBucketsY;
+	double dfBucketMinX;
+	double dfBucketMinY;
+	double dfBucketSize;
+	const double* padfColSin;		// sine and cosine of the longitude offset of the output columns
+	const double* padfColCos;
+	const double* padfRowSin;		// sine and cosine of the latitude of the output rows
+	const double* padfRowCos;
+	double dfSinLat0;
+	double dfCosLat0;
+	double dfMaxDist2;
+	int nXSize;
+	int nFirstRow;
+	int nRows;
+	int* panIndex;					// nearest pixel of each cell, -1 beyond the maximum distance
+} SwathNearestJob;
+
+static void SwathNearestWorker(void* pData)
+{
+	SwathNearestJob* psJob = (SwathNearestJob*) pData;
+	for (int iRow = 0; iRow < psJob->nRows; iRow++)
+	{
+		int iOutRow = psJob->nFirstRow + iRow;
+		int* panIndex = psJob->panIndex + (size_t)iRow * psJob->nXSize;
+		for (int iCol = 0; iCol < psJob->nXSize; iCol++)
+		{
+			panIndex[iCol] = -1;
+			float fX, fY;
+			if (!ProjectEqualArea(psJob->dfSinLat0, psJob->dfCosLat0, psJob->padfRowSin[iOutRow], psJob->padfRowCos[iOutRow],
+					psJob->padfColSin[iCol], psJob->padfColCos[iCol], &fX, &fY))
+				continue;
+			int nBX = (int)floor((fX - psJob->dfBucketMinX) / psJob->dfBucketSize);
+			int nBY = (int)floor((fY - psJob->dfBucketMinY) / psJob->dfBucketSize);
+			double dfBest = psJob->dfMaxDist2;
+			for (int iBY = MAX(0, nBY - 1); iBY <= MIN(psJob->nBucketsY - 1, nBY + 1); iBY++)
+			{
+				for (int iBX = MAX(0, nBX - 1); iBX <= MIN(psJob->nBucketsX - 1, nBX + 1); iBX++)
+				{
+					int iBucket = iBY * psJob->nBucketsX + iBX;
+					for (int k = psJob->panBucketStart[iBucket]; k < psJob->panBucketStart[iBucket + 1]; k++)
+					{
+						int iPixel = psJob->panBucketPixel[k];
+						double dfDX = psJob->pafX[iPixel] - fX;
+						double dfDY = psJob->pafY[iPixel] - fY;
+						double dfDist2 = dfDX * dfDX + dfDY * dfDY;
+						if (dfDist2 <= dfBest)
+						{
+							dfBest = dfDist2;
+							panIndex[iCol] = iPixel;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * \brief Resample the swath to a geographic grid with the nearest neighbor.
+ *
+ * This method is used to rectify a swath for the nearest neighbor
+ * interpolation without fitting polynomials to the GCPs. The location of
+ * each swath pixel is interpolated between the GCPs, which form a regular
+ * grid, and projected with a Lambert azimuthal equal-area projection
+ * centered on the output, where the distances are measured. Only the
+ * scanlines intersecting the output are used, see GetScanlineRanges().
+ * The pixels are indexed by a grid of buckets as large as the maximum
+ * distance, then the output rows are divided among threads, and each cell
+ * takes the value of the nearest pixel within the maximum distance, or the
+ * missing value. The output is written strip by strip, and band by band,
+ * only the scanlines holding the nearest pixels of a strip are read, in the
+ * data type of the swath, so the values are never held for the whole swath.
+ *
+ * @param sFileName The path of the output GeoTIFF file.
+ *
+ * @param adfGeoTransform The geotransform of the output grid, in degrees.
+ * Its west bound could be beyond 180 when it crosses the antimeridian.
+ *
+ * @param nXSize The width of the output grid.
+ *
+ * @param nYSize The height of the output grid.
+ *
+ * @param pszWKT The WKT of the output CRS.
+ *
+ * @param dfMaxDistance The maximum distance between the center of a cell and
+ * the nearest pixel, in meters. The largest spacing of the swath pixels is
+ * used when it is not positive.
+ *
+ * @param papszOptions The creation options of the output file.
+ *
+ * @return CE_None on success, CE_Warning if the geolocation of the swath
+ * could not be resampled by this method, or CE_Failure if the swath could
+ * not be read or the output written. No error is raised, the swath could
+ * still be warped by gdalwarp.
+ */
+
+CPLErr AbstractDataset::ResampleSwathNearest(const string& sFileName, const double adfGeoTransform[],
+		int nXSize, int nYSize, const char* pszWKT, double dfMaxDistance, char** papszOptions)
+{
+	GDALDataset* poSrcDS = maptrDS.get();
+	vector<double> adfPixel, adfLine, adfX, adfY;
+	int nGCPs = GetGeolocationGCPs(adfPixel, adfLine, adfX, adfY);
+	if (!poSrcDS || poSrcDS->GetRasterCount() < 1 || nGCPs < 4 || nXSize < 1 || nYSize < 1)
+		return CE_Warning;
+	int nSrcXSize = poSrcDS->GetRasterXSize();
+	int nSrcYSize = poSrcDS->GetRasterYSize();
+	int nBands = poSrcDS->GetRasterCount();
+
+	//step 1: the GCPs form a regular grid over the swath
+	vector<double> adfCols(adfPixel), adfRows(adfLine);
+	sort(adfCols.begin(), adfCols.end());
+	adfCols.erase(unique(adfCols.begin(), adfCols.end()), adfCols.end());
+	sort(adfRows.begin(), adfRows.end());
+	adfRows.erase(unique(adfRows.begin(), adfRows.end()), adfRows.end());
+	int nCols = (int)adfCols.size();
+	int nRows = (int)adfRows.size();
+	if (nCols < 2 || nRows < 2 || nCols * nRows != nGCPs)
+		return CE_Warning;
+	vector<double> adfGridX(nGCPs, -999), adfGridY(nGCPs, -999);
+	for (int i = 0; i < nGCPs; i++)
+	{
+		int iCol = lower_bound(adfCols.begin(), adfCols.end(), adfPixel[i]) - adfCols.begin();
+		int iRow = lower_bound(adfRows.begin(), adfRows.end(), adfLine[i]) - adfRows.begin();
+		adfGridX[iRow * nCols + iCol] = adfX[i];
+		adfGridY[iRow * nCols + iCol] = adfY[i];
+	}
+
+	//step 2: the output grid, and its extent in the equal-area projection
+	const double dfD2R = M_PI / 180.0;
+	double dfLon0 = adfGeoTransform[0] + nXSize * adfGeoTransform[1] / 2;
+	double dfLat0 = adfGeoTransform[3] + nYSize * adfGeoTransform[5] / 2;
+	double dfSinLat0 = sin(dfLat0 * dfD2R), dfCosLat0 = cos(dfLat0 * dfD2R);
+	vector<double> adfColSin(nXSize), adfColCos(nXSize), adfRowSin(nYSize), adfRowCos(nYSize);
+	for (int i = 0; i < nXSize; i++)
+	{
+		double dfDLon = (adfGeoTransform[0] + (i + 0.5) * adfGeoTransform[1] - dfLon0) * dfD2R;
+		adfColSin[i] = sin(dfDLon);
+		adfColCos[i] = cos(dfDLon);
+	}
+	for (int j = 0; j < nYSize; j++)
+	{
+		double dfLat = (adfGeoTransform[3] + (j + 0.5) * adfGeoTransform[5]) * dfD2R;
+		adfRowSin[j] = sin(dfLat);
+		adfRowCos[j] = cos(dfLat);
+	}
+	double dfMinPX = numeric_limits<double>::max(), dfMaxPX = -numeric_limits<double>::max();
+	double dfMinPY = numeric_limits<double>::max(), dfMaxPY = -numeric_limits<double>::max();
+	//the edges, and the middle row and column which could be the widest
+	int anLines[3] = {0, nYSize / 2, nYSize - 1};
+	int anSamples[3] = {0, nXSize / 2, nXSize - 1};
+	for (int n = 0; n < 2; n++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			for (int m = 0; m < (n == 0 ? nXSize : nYSize); m++)
+			{
+				int i = n == 0 ? m : anSamples[k];
+				int j = n == 0 ? anLines[k] : m;
+				float fX, fY;
+				if (!ProjectEqualArea(dfSinLat0, dfCosLat0, adfRowSin[j], adfRowCos[j], adfColSin[i], adfColCos[i], &fX, &fY))
+					continue;
+				dfMinPX = MIN(dfMinPX, fX);
+				dfMaxPX = MAX(dfMaxPX, fX);
+				dfMinPY = MIN(dfMinPY, fY);
+				dfMaxPY = MAX(dfMaxPY, fY);
+			}
+		}
+	}
+
+	//step 3: the scanlines intersecting the output
+	double dfMinX = adfGeoTransform[0] < -180.0 ? adfGeoTransform[0] + 360.0 : adfGeoTransform[0];
+	double dfMaxX = adfGeoTransform[0] + nXSize * adfGeoTransform[1];
+	if (dfMaxX > 180.0)
+		dfMaxX -= 360.0;
+	vector<int> anRanges;
+	if (CE_None != GetScanlineRanges(dfMinX, adfGeoTransform[3] + nYSize * adfGeoTransform[5], dfMaxX, adfGeoTransform[3], anRanges))
+	{
+		anRanges.push_back(0);
+		anRanges.push_back(nSrcYSize);
+	}
+	size_t nRangePixels = 0;
+	for (unsigned int i = 1; i < anRanges.size(); i += 2)
+		nRangePixels += (size_t)anRanges[i] * nSrcXSize;
+
+	//step 4: the maximum distance, from the largest spacing of the pixels around the GCPs
+	double dfMaxDist = dfMaxDistance;
+	if (!(dfMaxDist > 0))
+	{
+		dfMaxDist = 0;
+		for (unsigned int i = 0; i + 1 < anRanges.size(); i += 2)
+		{
+			int iFirstRow = MAX(0, (int)(upper_bound(adfRows.begin(), adfRows.end(), (double)anRanges[i]) - adfRows.begin()) - 1);
+			int iLastRow = MIN(nRows - 1, (int)(lower_bound(adfRows.begin(), adfRows.end(), (double)(anRanges[i] + anRanges[i + 1])) - adfRows.begin()));
+			for (int r = iFirstRow; r <= iLastRow; r++)
+			{
+				for (int c = 0; c < nCols; c++)
+				{
+					int g = r * nCols + c;
+					float fX, fY, fNX, fNY;
+					if (adfGridX[g] == -999 || !ProjectEqualArea(dfSinLat0, dfCosLat0, sin(adfGridY[g] * dfD2R), cos(adfGridY[g] * dfD2R),
+							sin((adfGridX[g] - dfLon0) * dfD2R), cos((adfGridX[g] - dfLon0) * dfD2R), &fX, &fY))
+						continue;
+					for (int n = 0; n < 2; n++)
+					{
+						int gn = n == 0 ? g + 1 : g + nCols;
+						if ((n == 0 && c + 1 >= nCols) || (n == 1 && r + 1 >= nRows) || adfGridX[gn] == -999 ||
+							!ProjectEqualArea(dfSinLat0, dfCosLat0, sin(adfGridY[gn] * dfD2R), cos(adfGridY[gn] * dfD2R),
+									sin((adfGridX[gn] - dfLon0) * dfD2R), cos((adfGridX[gn] - dfLon0) * dfD2R), &fNX, &fNY))
+							continue;
+						double dfStep = n == 0 ? adfCols[c + 1] - adfCols[c] : adfRows[r + 1] - adfRows[r];
+						double dfDist = sqrt(((double)fNX - fX) * ((double)fNX - fX) + ((double)fNY - fY) * ((double)fNY - fY));
+						dfMaxDist = MAX(dfMaxDist, dfDist / MAX(1.0, dfStep));
+					}
+				}
+			}
+		}
+	}
+	if (!(dfMaxDist > 0) || dfMinPX > dfMaxPX)
+		return CE_Warning;
+	dfMinPX -= dfMaxDist;
+	dfMaxPX += dfMaxDist;
+	dfMinPY -= dfMaxDist;
+	dfMaxPY += dfMaxDist;
+
+	//step 5: location of the swath pixels, interpolated between the GCPs
+	vector<int> anColGrid(nSrcXSize);
+	vector<double> adfColT(nSrcXSize);
+	for (int i = 0; i < nSrcXSize; i++)
+	{
+		int c = MAX(0, MIN(nCols - 2, (int)(upper_bound(adfCols.begin(), adfCols.end(), i + 0.5) - adfCols.begin()) - 1));
+		anColGrid[i] = c;
+		adfColT[i] = (i + 0.5 - adfCols[c]) / (adfCols[c + 1] - adfCols[c]);
+	}
+	vector<float> afX(nRangePixels + 1), afY(nRangePixels + 1);
+	vector<int> anInside;
+	size_t iPixel = 0;
+	for (unsigned int i = 0; i + 1 < anRanges.size(); i += 2)
+	{
+		for (int nLine = anRanges[i]; nLine < anRanges[i] + anRanges[i + 1]; nLine++)
+		{
+			int r = MAX(0, MIN(nRows - 2, (int)(upper_bound(adfRows.begin(), adfRows.end(), nLine + 0.5) - adfRows.begin()) - 1));
+			double dfU = (nLine + 0.5 - adfRows[r]) / (adfRows[r + 1] - adfRows[r]);
+			for (int nPixel = 0; nPixel < nSrcXSize; nPixel++, iPixel++)
+			{
+				int g00 = r * nCols + anColGrid[nPixel], g01 = g00 + 1, g10 = g00 + nCols, g11 = g10 + 1;
+				if (adfGridX[g00] == -999 || adfGridX[g01] == -999 || adfGridX[g10] == -999 || adfGridX[g11] == -999)
+					continue;
+				double dfT = adfColT[nPixel];
+				double adfLon[4] = {adfGridX[g00], adfGridX[g01], adfGridX[g10], adfGridX[g11]};
+				for (int k = 1; k < 4; k++)//unwrapped across the antimeridian
+					adfLon[k] += adfLon[k] - adfLon[0] > 180.0 ? -360.0 : (adfLon[k] - adfLon[0] < -180.0 ? 360.0 : 0.0);
+				double dfLon = (1 - dfU) * ((1 - dfT) * adfLon[0] + dfT * adfLon[1]) + dfU * ((1 - dfT) * adfLon[2] + dfT * adfLon[3]);
+				double dfLat = (1 - dfU) * ((1 - dfT) * adfGridY[g00] + dfT * adfGridY[g01]) +
+						dfU * ((1 - dfT) * adfGridY[g10] + dfT * adfGridY[g11]);
+				dfLat = MAX(-90.0, MIN(90.0, dfLat));
+				if (ProjectEqualArea(dfSinLat0, dfCosLat0, sin(dfLat * dfD2R), cos(dfLat * dfD2R),
+						sin((dfLon - dfLon0) * dfD2R), cos((dfLon - dfLon0) * dfD2R), &afX[iPixel], &afY[iPixel]) &&
+					afX[iPixel] >= dfMinPX && afX[iPixel] <= dfMaxPX && afY[iPixel] >= dfMinPY && afY[iPixel] <= dfMaxPY)
+					anInside.push_back((int)iPixel);
+			}
+		}
+	}
+
+	//step 6: bucket index of the pixels, with at most about four buckets per pixel
+	double dfBucketSize = dfMaxDist;
+	double dfArea = (dfMaxPX - dfMinPX) * (dfMaxPY - dfMinPY);
+	if (dfArea / (dfBucketSize * dfBucketSize) > 4.0 * anInside.size() + 1024)
+		dfBucketSize = sqrt(dfArea / (4.0 * anInside.size() + 1024));
+	int nBucketsX = MAX(1, (int)ceil((dfMaxPX - dfMinPX) / dfBucketSize));
+	int nBucketsY = MAX(1, (int)ceil((dfMaxPY - dfMinPY) / dfBucketSize));
+	vector<int> anBucketStart((size_t)nBucketsX * nBucketsY + 1, 0);
+	vector<int> anBucketOf(anInside.size());
+	for (unsigned int k = 0; k < anInside.size(); k++)
+	{
+		int nBX = MIN(nBucketsX - 1, (int)((afX[anInside[k]] - dfMinPX) / dfBucketSize));
+		int nBY = MIN(nBucketsY - 1, (int)((afY[anInside[k]] - dfMinPY) / dfBucketSize));
+		anBucketOf[k] = nBY * nBucketsX + nBX;
+		anBucketStart[anBucketOf[k] + 1]++;
+	}
+	for (size_t b = 1; b < anBucketStart.size(); b++)
+		anBucketStart[b] += anBucketStart[b - 1];
+	vector<int> anBucketPixel(anInside.size() + 1);
+	vector<int> anBucketFill(anBucketStart.begin(), anBucketStart.end() - 1);
+	for (unsigned int k = 0; k < anInside.size(); k++)
+		anBucketPixel[anBucketFill[anBucketOf[k]]++] = anInside[k];
+	vector<int>().swap(anBucketFill);
+	vector<int>().swap(anBucketOf);
+
+	//step 7: the output, strip by strip
+	GDALDataType eDataType = poSrcDS->GetRasterBand(1)->GetRasterDataType();
+	int nDTSize = GDALGetDataTypeSize(eDataType) / 8;
+	GDALDriver* poDriver = (GDALDriver*) GDALGetDriverByName("GTiff");
+	GDALDataset* poOutDS = poDriver ? poDriver->Create(sFileName.c_str(), nXSize, nYSize, nBands,
+			eDataType, papszOptions) : NULL;
+	if (!poOutDS)
+		return CE_Failure;
+	double adfOutGeoTransform[6];
+	memcpy(adfOutGeoTransform, adfGeoTransform, sizeof(adfOutGeoTransform));
+	poOutDS->SetGeoTransform(adfOutGeoTransform);
+	poOutDS->SetProjection(pszWKT);
+	for (int iBand = 1; iBand <= nBands; iBand++)
+		poOutDS->GetRasterBand(iBand)->SetNoDataValue(md_MissingValue);
+
+	//the first row of each scanline range in the located pixels
+	vector<int> anRangeRow(1, 0);
+	for (unsigned int i = 0; i + 1 < anRanges.size(); i += 2)
+		anRangeRow.push_back(anRangeRow.back() + anRanges[i + 1]);
+	GByte abyMissing[16];
+	GDALCopyWords(&md_MissingValue, GDT_Float64, 0, abyMissing, eDataType, 0, 1);
+
+	int nThreads = MAX(1, MIN(16, CPLGetNumCPUs()));
+	int nStripRows = MAX(1, MIN(nYSize, (1 << 20) / nXSize));
+	vector<int> anIndex((size_t)nStripRows * nXSize);
+	vector<GByte> abyStrip((size_t)nStripRows * nXSize * nDTSize);
+	vector<GByte> abyLines;
+	vector<SwathNearestJob> asJobs(nThreads);
+	vector<CPLJoinableThread*> ahThreads(nThreads);
+	CPLErr eErr = CE_None;
+	for (int nStripRow = 0; nStripRow < nYSize && eErr == CE_None; nStripRow += nStripRows)
+	{
+		int nRowsInStrip = MIN(nStripRows, nYSize - nStripRow);
+		int nRowsPerJob = (nRowsInStrip + nThreads - 1) / nThreads;
+		for (int t = 0; t < nThreads; t++)
+		{
+			SwathNearestJob& sJob = asJobs[t];
+			sJob.pafX = &afX[0];
+			sJob.pafY = &afY[0];
+			sJob.panBucketStart = &anBucketStart[0];
+			sJob.panBucketPixel = &anBucketPixel[0];
+			sJob.nBucketsX = nBucketsX;
+			sJob.nBucketsY = nBucketsY;
+			sJob.dfBucketMinX = dfMinPX;
+			sJob.dfBucketMinY = dfMinPY;
+			sJob.dfBucketSize = dfBucketSize;
+			sJob.padfColSin = &adfColSin[0];
+			sJob.padfColCos = &adfColCos[0];
+			sJob.padfRowSin = &adfRowSin[0];
+			sJob.padfRowCos = &adfRowCos[0];
+			sJob.dfSinLat0 = dfSinLat0;
+			sJob.dfCosLat0 = dfCosLat0;
+			sJob.dfMaxDist2 = dfMaxDist * dfMaxDist;
+			sJob.nXSize = nXSize;
+			sJob.nFirstRow = nStripRow + t * nRowsPerJob;
+			sJob.nRows = MAX(0, MIN(nRowsPerJob, nStripRow + nRowsInStrip - sJob.nFirstRow));
+			sJob.panIndex = &anIndex[(size_t)MIN(t * nRowsPerJob, nRowsInStrip) * nXSize];
+			ahThreads[t] = sJob.nRows > 0 && t > 0 ? CPLCreateJoinableThread(SwathNearestWorker, &sJob) : NULL;
+			if (sJob.nRows > 0 && !ahThreads[t] && t > 0)
+				SwathNearestWorker(&sJob);
+		}
+		SwathNearestWorker(&asJobs[0]);
+		for (int t = 1; t < nThreads; t++)
+			if (ahThreads[t])
+				CPLJoinThread(ahThreads[t]);
+
+		//Only the scanlines of the nearest pixels of the strip are read, band by band, in the data type of the swath
+		size_t nCells = (size_t)nRowsInStrip * nXSize;
+		int nMinIndex = -1, nMaxIndex = -1;
+		for (size_t k = 0; k < nCells; k++)
+		{
+			if (anIndex[k] < 0)
+				continue;
+			nMinIndex = nMinIndex < 0 ? anIndex[k] : MIN(nMinIndex, anIndex[k]);
+			nMaxIndex = MAX(nMaxIndex, anIndex[k]);
+		}
+		int nFirstRow = nMinIndex < 0 ? 0 : nMinIndex / nSrcXSize;
+		int nEndRow = nMinIndex < 0 ? 0 : nMaxIndex / nSrcXSize + 1;
+		abyLines.resize(MAX(abyLines.size(), (size_t)(nEndRow - nFirstRow) * nSrcXSize * nDTSize));
+		size_t nFirstPixel = (size_t)nFirstRow * nSrcXSize;
+
+		for (int iBand = 0; iBand < nBands && eErr == CE_None; iBand++)
+		{
+			for (unsigned int i = 0; i + 1 < anRangeRow.size() && eErr == CE_None; i++)
+			{
+				int nRow0 = MAX(nFirstRow, anRangeRow[i]), nRow1 = MIN(nEndRow, anRangeRow[i + 1]);
+				if (nRow0 < nRow1)
+					eErr = poSrcDS->GetRasterBand(iBand + 1)->RasterIO(GF_Read, 0, anRanges[2 * i] + nRow0 - anRangeRow[i],
+							nSrcXSize, nRow1 - nRow0, &abyLines[(size_t)(nRow0 - nFirstRow) * nSrcXSize * nDTSize],
+							nSrcXSize, nRow1 - nRow0, eDataType, 0, 0);
+			}
+			for (size_t k = 0; k < nCells && eErr == CE_None; k++)
+				memcpy(&abyStrip[k * nDTSize], anIndex[k] >= 0 ?
+						&abyLines[(anIndex[k] - nFirstPixel) * nDTSize] : abyMissing, nDTSize);
+			if (eErr == CE_None)
+				eErr = poOutDS->GetRasterBand(iBand + 1)->RasterIO(GF_Write, 0, nStripRow, nXSize, nRowsInStrip,
+						&abyStrip[0], nXSize, nRowsInStrip, eDataType, 0, 0);
+		}
+	}
+	GDALClose(poOutDS);
+
+	return eErr;
+}
+
 /************************************************************************/
 /*                        IsCrossingIDL()                               */
 /************************************************************************/
@@ -990,7 +1764,7 @@ int AbstractDataset::IsCrossingIDL()
 	GetNativeBBox(bboxArray);
 
 	OGRSpatialReference latlonSRS;
-	latlonSRS.SetWellKnownGeogCS("WGS84");
+	ImportRegisteredCRS(latlonSRS, "WGS84");
 	My2DPoint llPtex(bboxArray[0], bboxArray[2]);
 	My2DPoint urPtex(bboxArray[1], bboxArray[3]);
 	bBox_transFormmate(mo_NativeCRS, latlonSRS, llPtex, urPtex);
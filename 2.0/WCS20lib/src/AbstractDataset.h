@@ -83,11 +83,26 @@ protected:
 
 	int 			mb_GeoTransformSet;
 	int				mb_IsVirtualDS;
+	int				mb_IsWholeFile;
 
 	OGRSpatialReference 	mo_NativeCRS;
 
+	// Geolocation of swath coverage, from the GCPs or the sidecar file
+	string			ms_GeolSidecarName;
+	int				mi_GeolGCPCount;
+	string			ms_GeolGCPProjection;
+	My2DPoint		mo_GeolLowLeft;
+	My2DPoint		mo_GeolUpRight;
+	double			md_GeolFootprint[8];// Order: upper-left, upper-right, lower-right, lower-left
+	const double*	mp_GeolGCPs;		// pixel, line, x, y of each GCP, when mapped from the sidecar
+	void*			mp_GeolMap;
+	size_t			mn_GeolMapSize;
+
 protected:
 	AbstractDataset();
+	int LoadGeolocationSidecar(const string& sMode);
+	CPLErr SetGeolocationFromGCPs();
+	int GetGeolocationGCPs(vector<double>& adfPixel, vector<double>& adfLine, vector<double>& adfX, vector<double>& adfY);
 	virtual CPLErr SetNativeCRS();
 	virtual CPLErr SetGeoTransform();
 	virtual CPLErr SetGDALDataset(const int isSimple=0);
@@ -110,6 +125,9 @@ public:
 	vector<int> 	GetBandList();
 	void 			GetNativeBBox(double bBox[]);
 	CPLErr 			GetGeoMinMax(double geoMinMax[]);
+	CPLErr 			GetScanlineRanges(double dfMinX, double dfMinY, double dfMaxX, double dfMaxY, vector<int>& anRanges);
+	CPLErr 			ResampleSwathNearest(const string& sFileName, const double adfGeoTransform[], int nXSize, int nYSize,
+						const char* pszWKT, double dfMaxDistance, char** papszOptions);
 
 	int			GetImageBandCount();
 	int 		GetImageXSize();
@@ -137,6 +155,7 @@ public:
 	// Fetch Variables Status Related
 	int 		IsbGeoTransformSet();
 	int 		IsCrossingIDL();
+	int 		IsWholeFileCoverage();
 
 	CPLErr GetSuggestedWarpResolution(OGRSpatialReference& dstCRS, double adfDstGeoTransform[], int &nPixels, int &nLines);
 	CPLErr GetSuggestedWarpResolution2(OGRSpatialReference& dstCRS, double adfDstGeoTransform[], int &nPixels, int &nLines);
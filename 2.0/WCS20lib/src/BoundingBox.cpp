@@ -30,140 +30,321 @@
  ****************************************************************************/
 
 #include <vector>
+#include <map>
+#include <math.h>
 #include <iostream>
+#include <pthread.h>
+#include <cpl_multiproc.h>
 #include "BoundingBox.h"
+#include "wcsUtil.h"
 #include "wcs_error.h"
 
 using namespace std;
 
-My2DPoint::~My2DPoint()
-{
+static CPLMutex* hCTCacheMutex = NULL;
+static map<string, OGRCoordinateTransformation*> oCTCache;
 
-}
+typedef map<string, OGRCoordinateTransformation*> CTCloneMap;
+static pthread_key_t hCTCloneKey;
+static pthread_once_t hCTCloneKeyOnce = PTHREAD_ONCE_INIT;
 
-BoundingBox::BoundingBox()
+/* Destroy the clones of a thread when it exits. */
+static void DestroyCTClones(void* pData)
 {
-
+	CTCloneMap* poClones = (CTCloneMap*) pData;
+	for (CTCloneMap::iterator it = poClones->begin(); it != poClones->end(); ++it)
+		OCTDestroyCoordinateTransformation((OGRCoordinateTransformationH) it->second);
+	delete poClones;
 }
 
-BoundingBox::~BoundingBox()
+static void CreateCTCloneKey()
 {
-
+	pthread_key_create(&hCTCloneKey, DestroyCTClones);
 }
 
-BoundingBox BoundingBox::TransformWorkExtend(OGRSpatialReference &dstCRS, int &IsOK)
+/**
+ * Fetch the coordinate transformation between two CRS from the process-wide
+ * cache, creating it on first use. Creating a transformation parses both CRS
+ * definitions and builds the PROJ pipeline, so it is done once per pair of
+ * CRS, keyed by their WKT. The WKT themselves are compared on lookup, so two
+ * pairs of CRS never share a transformation. The PROJ objects could not be used
+ * by several threads at once, so each thread gets its own clone of the cached
+ * transformation, kept in thread-specific data and destroyed when the thread
+ * exits. The returned transformation is owned by the cache and must not be
+ * destroyed by the caller.
+ */
+OGRCoordinateTransformation* CPL_STDCALL GetCachedTransformation(OGRSpatialReference& oSrcCRS,
+		OGRSpatialReference& oDesCRS)
 {
-	if (mo_CRS.IsSame(&dstCRS))
+	char* pszSrcWKT = NULL;
+	char* pszDesWKT = NULL;
+	oSrcCRS.exportToWkt(&pszSrcWKT);
+	oDesCRS.exportToWkt(&pszDesWKT);
+	string sKey = string(pszSrcWKT ? pszSrcWKT : "") + "\n" + string(pszDesWKT ? pszDesWKT : "");
+	CPLFree(pszSrcWKT);
+	CPLFree(pszDesWKT);
+
+	pthread_once(&hCTCloneKeyOnce, CreateCTCloneKey);
+	CTCloneMap* poClones = (CTCloneMap*) pthread_getspecific(hCTCloneKey);
+	if (poClones == NULL)
 	{
-		IsOK = TRUE;
-		return *this;
+		poClones = new CTCloneMap();
+		pthread_setspecific(hCTCloneKey, poClones);
 	}
 
-	OGRCoordinateTransformation *poCT = OGRCreateCoordinateTransformation(&mo_CRS, &dstCRS);
-	if (poCT == NULL)
-	{
-		IsOK = FALSE;
-		return *this;
-	}
+	CTCloneMap::iterator itClone = poClones->find(sKey);
+	if (itClone != poClones->end())
+		return itClone->second;
 
-	double xdes = (mo_UpperRightPT.mi_X - mo_LowerLeftPT.mi_X) / 100;
+	CPLMutexHolderD(&hCTCacheMutex);
 
-	if (mo_CRS.IsGeographic()
-			&& mo_UpperRightPT.mi_X < mo_LowerLeftPT.mi_X
-			&& mo_LowerLeftPT.mi_X > 0 && mo_UpperRightPT.mi_X < 0)
+	map<string, OGRCoordinateTransformation*>::iterator it = oCTCache.find(sKey);
+	if (it == oCTCache.end())
 	{
-		xdes = (360 + mo_UpperRightPT.mi_X - mo_LowerLeftPT.mi_X) / 100;
+		OGRCoordinateTransformation *poCT = OGRCreateCoordinateTransformation(&oSrcCRS, &oDesCRS);
+		if (poCT == NULL)
+			return NULL;
+		it = oCTCache.insert(make_pair(sKey, poCT)).first;
 	}
 
-	vector<double> x;
-	vector<double> y;
-	//up and down edge
-	for (double stepX = mo_LowerLeftPT.mi_X; stepX < mo_UpperRightPT.mi_X; stepX
-			+= xdes)
-	{
-		x.push_back(stepX);
-		y.push_back(mo_UpperRightPT.mi_Y);
-		x.push_back(stepX);
-		y.push_back(mo_LowerLeftPT.mi_Y);
-	}
-	x.push_back(mo_UpperRightPT.mi_X);
-	y.push_back(mo_UpperRightPT.mi_Y);
-	x.push_back(mo_UpperRightPT.mi_X);
-	y.push_back(mo_LowerLeftPT.mi_Y);
+	OGRCoordinateTransformation *poClone = it->second->Clone();
+	if (poClone == NULL)
+		return NULL;
+	(*poClones)[sKey] = poClone;
 
-	double yMin = numeric_limits<double>::max();
-	double yMax = numeric_limits<double>::min();
+	return poClone;
+}
 
-	int k = 0;
-	vector<int> bSuccess;
-	vector<double> tmpX;
-	vector<double> tmpY;
+static CPLMutex* hCRSRegistryMutex = NULL;
+static map<string, RegisteredCRS*> oCRSRegistry;
 
-	for (unsigned int i = 0; i < x.size(); i++)
+/*
+ * Fetch the registered CRS of the definition, parsing it on first use. The
+ * registry mutex must be held by the caller. EPSG codes and URNs are compared
+ * case-insensitively, the other definitions (WKT, PROJ strings, URIs) are
+ * compared as they are. The registered CRS are never modified nor released.
+ */
+static RegisteredCRS* FetchRegisteredCRS(const char* pszDefinition)
+{
+	if (NULL == pszDefinition)
+		return NULL;
+
+	CPLString sKey(pszDefinition);
+	sKey.Trim();
+	if (sKey.empty())
+		return NULL;
+	if (EQUALN(sKey.c_str(), "EPSG:", 5) || EQUALN(sKey.c_str(), "URN:", 4))
+		sKey.toupper();
+
+	map<string, RegisteredCRS*>::iterator it = oCRSRegistry.find(sKey);
+	if (it != oCRSRegistry.end())
+		return it->second;
+
+	RegisteredCRS* poCRS = new RegisteredCRS();
+	if (OGRERR_NONE != poCRS->mo_SRS.SetFromUserInput(pszDefinition))
 	{
-		tmpX.push_back(x[i]);
-		tmpY.push_back(y[i]);
-		bSuccess.push_back(0);
+		delete poCRS;
+		return NULL;
 	}
+	poCRS->mb_Geographic = poCRS->mo_SRS.IsGeographic();
+	poCRS->mb_LatLong = poCRS->mo_SRS.EPSGTreatsAsLatLong();
+	poCRS->md_Units = poCRS->mb_Geographic ? poCRS->mo_SRS.GetAngularUnits() : poCRS->mo_SRS.GetLinearUnits();
+	oCRSRegistry[sKey] = poCRS;
+
+	return poCRS;
+}
 
-	poCT->TransformEx(x.size(), &tmpX[0], &tmpY[0], NULL, &bSuccess[0]);
+/**
+ * Fetch the parsed CRS of a CRS code, URN, URI or WKT from the process-wide
+ * CRS registry, with its geographic, axis order and units flags. The
+ * definitions are parsed once per process, so repeated EPSG lookups do not
+ * query the PROJ database again, and the flags are not computed again.
+ * Returns NULL if the definition could not be parsed.
+ */
+const RegisteredCRS* CPL_STDCALL GetRegisteredCRS(const char* pszDefinition)
+{
+	CPLMutexHolderD(&hCRSRegistryMutex);
 
-	for (unsigned int n = 0; n < x.size(); n++)
+	return FetchRegisteredCRS(pszDefinition);
+}
+
+/**
+ * Set the CRS from a CRS code, URN, URI or WKT, as SetFromUserInput() does,
+ * by copying the parsed CRS from the process-wide CRS registry.
+ */
+OGRErr CPL_STDCALL ImportRegisteredCRS(OGRSpatialReference& oCRS, const char* pszDefinition)
+{
+	CPLMutexHolderD(&hCRSRegistryMutex);
+
+	RegisteredCRS* poCRS = FetchRegisteredCRS(pszDefinition);
+	if (NULL == poCRS)
+		return OGRERR_UNSUPPORTED_SRS;
+
+	oCRS = poCRS->mo_SRS;
+
+	return OGRERR_NONE;
+}
+
+My2DPoint::~My2DPoint()
+{
+
+}
+
+BoundingBox::BoundingBox()
+{
+
+}
+
+BoundingBox::~BoundingBox()
+{
+
+}
+
+/*
+ * Fold the upper half of the samples onto the lower half until one is left,
+ * and merge it into the range. Each fold is an elementwise select without a
+ * loop-carried dependency, which GCC vectorizes (minpd/maxpd) at -O3 without
+ * -ffast-math; a running min/max is not. The samples are overwritten, and
+ * those which failed to transform hold the largest (or lowest) double.
+ */
+static void FoldMinMax(double* padfMin, double* padfMax, int nCount, double& dfMin, double& dfMax)
+{
+	while (nCount > 1)
 	{
-		if (bSuccess[n])
+		int nHalf = nCount / 2;
+		const double* padfUpperMin = padfMin + nCount - nHalf;
+		const double* padfUpperMax = padfMax + nCount - nHalf;
+		for (int i = 0; i < nHalf; i++)
 		{
-			++k;
-			yMin = MIN(yMin,tmpY[n]);
-			yMax = MAX(yMax,tmpY[n]);
+			padfMin[i] = padfUpperMin[i] < padfMin[i] ? padfUpperMin[i] : padfMin[i];
+			padfMax[i] = padfUpperMax[i] > padfMax[i] ? padfUpperMax[i] : padfMax[i];
 		}
+		nCount -= nHalf;
+	}
+	if (nCount == 1)
+	{
+		dfMin = MIN(dfMin, padfMin[0]);
+		dfMax = MAX(dfMax, padfMax[0]);
 	}
+}
 
-	if (k < 80)
+/*
+ * Transform the bounding box with adaptive densification, in one batched
+ * call. The top and bottom edges are sampled with 16 segments, then 32 and
+ * so on up to 1024; the samples of each level are laid out after those of
+ * the coarser levels, followed by the four corners, and all are transformed
+ * with one TransformEx call. The y range is then refined level by level,
+ * folding only the samples new to the level, until two successive estimates
+ * agree within the tolerance, which defaults to a ten-thousandth of the
+ * transformed extent, a fraction of a pixel for any output below several
+ * thousand pixels. The corners give the x range. The longitudes of a
+ * geographic box crossing the antimeridian are normalized to [-180, 180].
+ * Returns FALSE if less than 40 percent of the edge samples of a level, or
+ * a corner, could be transformed.
+ */
+static int TransformBBoxAdaptive(OGRCoordinateTransformation *poCT, int bGeographic, double dfMinX, double dfMinY,
+		double dfWidth, double dfMaxY, double dfTolerance,
+		double& xMin, double& yMin, double& xMax, double& yMax)
+{
+	const int nMinSegments = 16;
+	const int nMaxSegments = 1024;
+	vector<double> x, y;
+	vector<int> anLevelEnd;
+	for (int nSegments = nMinSegments; nSegments <= nMaxSegments; nSegments *= 2)
 	{
-		IsOK = FALSE;
-		OCTDestroyCoordinateTransformation(poCT);
-		return *this;
+		int nStep = nMaxSegments / nSegments;
+		for (int nEdge = 0; nEdge < 2; nEdge++)
+		{
+			for (int i = 0; i <= nMaxSegments; i += nStep)
+			{
+				if (nSegments > nMinSegments && i % (2 * nStep) == 0)//sample of a coarser level
+					continue;
+				double dfX = dfMinX + dfWidth * i / nMaxSegments;
+				x.push_back(bGeographic && dfX > 180.0 ? dfX - 360.0 : dfX);
+				y.push_back(nEdge == 0 ? dfMaxY : dfMinY);
+			}
+		}
+		anLevelEnd.push_back((int)x.size());
+	}
+	int iCorner = (int)x.size();
+	double dfRightX = bGeographic && dfMinX + dfWidth > 180.0 ? dfMinX + dfWidth - 360.0 : dfMinX + dfWidth;
+	double adfCornerX[4] = {dfMinX, dfMinX, dfRightX, dfRightX};
+	double adfCornerY[4] = {dfMaxY, dfMinY, dfMaxY, dfMinY};
+	x.insert(x.end(), adfCornerX, adfCornerX + 4);
+	y.insert(y.end(), adfCornerY, adfCornerY + 4);
+	int nCount = iCorner + 4;
+	vector<int> bSuccess(nCount, 0);
+
+	poCT->TransformEx(nCount, &x[0], &y[0], NULL, &bSuccess[0]);
+
+	if (!bSuccess[iCorner] || !bSuccess[iCorner + 1] || !bSuccess[iCorner + 2] || !bSuccess[iCorner + 3])
+		return FALSE;
+	xMin = MIN(x[iCorner], x[iCorner + 1]);
+	xMax = MAX(x[iCorner + 2], x[iCorner + 3]);
+
+	vector<double> adfMin(iCorner), adfMax(iCorner);
+	for (int n = 0; n < iCorner; n++)
+	{
+		adfMin[n] = bSuccess[n] ? y[n] : numeric_limits<double>::max();
+		adfMax[n] = bSuccess[n] ? y[n] : -numeric_limits<double>::max();
 	}
 
-	//find xmin on left edge and xmax on right edge
-	double xMin;
-	double xMax;
+	double dfYMin = numeric_limits<double>::max();
+	double dfYMax = -numeric_limits<double>::max();
+	int k = 0, nStart = 0;
+	for (size_t iLevel = 0; iLevel < anLevelEnd.size(); iLevel++)
+	{
+		int nEnd = anLevelEnd[iLevel];
+		for (int n = nStart; n < nEnd; n++)
+			k += bSuccess[n] ? 1 : 0;
 
-	double tmpPTX[2];
-	double tmpPTY[2];
+		//at least 40 percent of the edge samples, as the 80 of about 200 samples with the fixed 100 steps
+		if (k * 5 < nEnd * 2)
+			return FALSE;
 
-	int isSucc[2];
+		double dfPrevYMin = dfYMin, dfPrevYMax = dfYMax;
+		FoldMinMax(&adfMin[nStart], &adfMax[nStart], nEnd - nStart, dfYMin, dfYMax);
+		nStart = nEnd;
 
-	tmpPTX[0] = mo_LowerLeftPT.mi_X;
-	tmpPTX[1] = mo_LowerLeftPT.mi_X;
-	tmpPTY[0] = mo_LowerLeftPT.mi_Y;
-	tmpPTY[1] = mo_UpperRightPT.mi_Y;
+		double dfTol = dfTolerance > 0 ? dfTolerance : MAX(xMax - xMin, dfYMax - dfYMin) * 1e-4;
+		if (iLevel > 0 && fabs(dfYMin - dfPrevYMin) <= dfTol && fabs(dfYMax - dfPrevYMax) <= dfTol)
+			break;
+	}
+	yMin = dfYMin;
+	yMax = dfYMax;
 
-	poCT->TransformEx(2, tmpPTX, tmpPTY, NULL, isSucc);
-	if (isSucc[0] && isSucc[1])
+	return TRUE;
+}
+
+BoundingBox BoundingBox::TransformWorkExtend(OGRSpatialReference &dstCRS, int &IsOK)
+{
+	if (mo_CRS.IsSame(&dstCRS))
 	{
-		xMin = MIN(tmpPTX[0],tmpPTX[1]);
+		IsOK = TRUE;
+		return *this;
 	}
-	else
+
+	OGRCoordinateTransformation *poCT = GetCachedTransformation(mo_CRS, dstCRS);
+	if (poCT == NULL)
 	{
-		OCTDestroyCoordinateTransformation(poCT);
 		IsOK = FALSE;
 		return *this;
 	}
 
-	tmpPTX[0] = mo_UpperRightPT.mi_X;
-	tmpPTX[1] = mo_UpperRightPT.mi_X;
-	tmpPTY[0] = mo_UpperRightPT.mi_Y;
-	tmpPTY[1] = mo_LowerLeftPT.mi_Y;
+	double dfWidth = mo_UpperRightPT.mi_X - mo_LowerLeftPT.mi_X;
+	int bGeographic = mo_CRS.IsGeographic();
 
-	poCT->TransformEx(2, tmpPTX, tmpPTY, NULL, isSucc);
-	if (isSucc[0] && isSucc[1])
+	if (bGeographic
+			&& mo_UpperRightPT.mi_X < mo_LowerLeftPT.mi_X
+			&& mo_LowerLeftPT.mi_X > 0 && mo_UpperRightPT.mi_X < 0)
 	{
-		xMax = MAX(tmpPTX[0],tmpPTX[1]);
+		dfWidth = 360 + mo_UpperRightPT.mi_X - mo_LowerLeftPT.mi_X;
 	}
-	else
+
+	double xMin, yMin, xMax, yMax;
+	if (!TransformBBoxAdaptive(poCT, bGeographic, mo_LowerLeftPT.mi_X, mo_LowerLeftPT.mi_Y, dfWidth, mo_UpperRightPT.mi_Y,
+			0, xMin, yMin, xMax, yMax))
 	{
-		OCTDestroyCoordinateTransformation(poCT);
 		IsOK = FALSE;
 		return *this;
 	}
@@ -191,7 +372,6 @@ BoundingBox BoundingBox::TransformWorkExtend(OGRSpatialReference &dstCRS, int &I
 		if (yMax > 90.)
 			yMax = 90.;
 	}
-	OCTDestroyCoordinateTransformation(poCT);
 	IsOK = TRUE;
 	return BoundingBox(My2DPoint(xMin, yMin), My2DPoint(xMax, yMax), dstCRS);
 }
@@ -215,12 +395,12 @@ BoundingBox BoundingBox::Transform(const double GeoTransform[])
  * so lowLeft.x maybe bigger than upRight.x
  */
 CPLErr CPL_STDCALL bBox_transFormmate(OGRSpatialReference& oSrcCRS,
-		OGRSpatialReference& oDesCRS, My2DPoint& lowLeft, My2DPoint& upRight)
+		OGRSpatialReference& oDesCRS, My2DPoint& lowLeft, My2DPoint& upRight, double dfTolerance)
 {
 	if (oSrcCRS.IsSame(&oDesCRS))
 		return CE_None;
 
-	OGRCoordinateTransformation *poCT = OGRCreateCoordinateTransformation(&oSrcCRS, &oDesCRS);
+	OGRCoordinateTransformation *poCT = GetCachedTransformation(oSrcCRS, oDesCRS);
 	if (poCT == NULL)
 	{
 		SetWCS_ErrorLocator("bBox_transFormmate()");
@@ -228,105 +408,22 @@ CPLErr CPL_STDCALL bBox_transFormmate(OGRSpatialReference& oSrcCRS,
 		return CE_Failure;
 	}
 
-	double xdes = (upRight.mi_X - lowLeft.mi_X) / 100;
-	if (oSrcCRS.IsGeographic() && upRight.mi_X < lowLeft.mi_X && lowLeft.mi_X > 0 && upRight.mi_X < 0)
-	{
-		xdes = (360 + upRight.mi_X - lowLeft.mi_X) / 100;
-	}
-
-	vector<double> x, y;
-	//up and down edge
-	for (double stepX = lowLeft.mi_X; stepX < upRight.mi_X; stepX += xdes)
-	{
-		x.push_back(stepX);
-		y.push_back(upRight.mi_Y);
-		x.push_back(stepX);
-		y.push_back(lowLeft.mi_Y);
-	}
-	x.push_back(upRight.mi_X);
-	y.push_back(upRight.mi_Y);
-	x.push_back(upRight.mi_X);
-	y.push_back(lowLeft.mi_Y);
-
-	double yMin = numeric_limits<double>::max();
-	double yMax = -numeric_limits<double>::max();
-
-	int k = 0;
-	vector<int> bSuccess;
-	vector<double> tmpX;
-	vector<double> tmpY;
-
-	for (unsigned int i = 0; i < x.size(); i++)
+	double dfWidth = upRight.mi_X - lowLeft.mi_X;
+	int bGeographic = oSrcCRS.IsGeographic();
+	if (bGeographic && upRight.mi_X < lowLeft.mi_X && lowLeft.mi_X > 0 && upRight.mi_X < 0)
 	{
-		tmpX.push_back(x[i]);
-		tmpY.push_back(y[i]);
-		bSuccess.push_back(0);
+		dfWidth = 360 + upRight.mi_X - lowLeft.mi_X;
 	}
 
-	poCT->TransformEx(x.size(), &tmpX[0], &tmpY[0], NULL, &bSuccess[0]);
-
-	for (unsigned int n = 0; n < x.size(); n++)
+	double xMin, yMin, xMax, yMax;
+	if (!TransformBBoxAdaptive(poCT, bGeographic, lowLeft.mi_X, lowLeft.mi_Y, dfWidth, upRight.mi_Y,
+			dfTolerance, xMin, yMin, xMax, yMax))
 	{
-		if (bSuccess[n])
-		{
-			++k;
-			yMin = MIN(yMin,tmpY[n]);
-			yMax = MAX(yMax,tmpY[n]);
-		}
-	}
-
-	if (k < 80)
-	{
-		OCTDestroyCoordinateTransformation(poCT);
 		SetWCS_ErrorLocator("bBox_transFormmate()");
 		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to Transform Coordinates");
 		return CE_Failure;
 	}
 
-	double xMin;
-	double xMax;
-
-	//find xmin on left edge and xmax on right edge
-	double tmpPTX[2];
-	double tmpPTY[2];
-	int isOK[2];
-
-	tmpPTX[0] = lowLeft.mi_X;
-	tmpPTX[1] = lowLeft.mi_X;
-	tmpPTY[0] = upRight.mi_Y;
-	tmpPTY[1] = lowLeft.mi_Y;
-
-	poCT->TransformEx(2, tmpPTX, tmpPTY, NULL, isOK);
-	if (isOK[0] && isOK[1])
-	{
-		xMin = MIN(tmpPTX[0],tmpPTX[1]);
-	}
-	else
-	{
-		OCTDestroyCoordinateTransformation(poCT);
-		SetWCS_ErrorLocator("bBox_transFormmate()");
-		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to Transform Coordinates");
-		return CE_Failure;
-	}
-
-	tmpPTX[0] = upRight.mi_X;
-	tmpPTX[1] = upRight.mi_X;
-	tmpPTY[0] = upRight.mi_Y;
-	tmpPTY[1] = lowLeft.mi_Y;
-
-	poCT->TransformEx(2, tmpPTX, tmpPTY, NULL, isOK);
-	if (isOK[0] && isOK[1])
-	{
-		xMax = MAX(tmpPTX[0],tmpPTX[1]);
-	}
-	else
-	{
-		SetWCS_ErrorLocator("bBox_transFormmate()");
-		OCTDestroyCoordinateTransformation(poCT);
-		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to Transform Coordinates");
-		return CE_Failure;
-	}
-	
 	lowLeft.mi_X = xMin;
 	lowLeft.mi_Y = yMin;
 	upRight.mi_X = xMax;
@@ -353,7 +450,6 @@ CPLErr CPL_STDCALL bBox_transFormmate(OGRSpatialReference& oSrcCRS,
 		if (upRight.mi_Y >= 90.)
 			upRight.mi_Y = 90.;
 	}
-	OCTDestroyCoordinateTransformation(poCT);
 
 	return CE_None;
 }
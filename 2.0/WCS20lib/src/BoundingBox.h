@@ -129,9 +129,39 @@ public:
 	BoundingBox Transform(const double*);
 };
 
+/************************************************************************/
+/* ==================================================================== */
+/*                            RegisteredCRS                             */
+/* ==================================================================== */
+/************************************************************************/
+
+/**
+ * \class RegisteredCRS "BoundingBox.h"
+ *
+ * RegisteredCRS is a parsed CRS interned in the process-wide CRS registry,
+ * together with the flags which are computed once when it is parsed. The
+ * registered objects are never modified nor released.
+ */
+
+class RegisteredCRS
+{
+public:
+	OGRSpatialReference mo_SRS;
+	int mb_Geographic;		//Is it a geographic CRS?
+	int mb_LatLong;			//Is the EPSG axis order latitude, longitude?
+	double md_Units;		//Angular units in radians, or linear units in meters
+};
+
+const RegisteredCRS CPL_DLL * CPL_STDCALL GetRegisteredCRS(const char* pszDefinition);
+OGRErr CPL_DLL CPL_STDCALL ImportRegisteredCRS(OGRSpatialReference& oCRS, const char* pszDefinition);
+
+OGRCoordinateTransformation CPL_DLL * CPL_STDCALL GetCachedTransformation(OGRSpatialReference&,
+												OGRSpatialReference&);
+
 CPLErr CPL_DLL CPL_STDCALL bBox_transFormmate(	OGRSpatialReference&,
 												OGRSpatialReference&,
 												My2DPoint& lowLeft,
-												My2DPoint& upRight);
+												My2DPoint& upRight,
+												double dfTolerance = 0);
 
 #endif /* BOUNDINGBOX_H_ */
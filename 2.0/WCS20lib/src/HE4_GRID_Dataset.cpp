@@ -390,19 +390,19 @@ CPLErr HE4_GRID_Dataset::SetNativeCRS()
 			case 16:// Sinusiodal
 			{
 				char *tmp = (char*) MODIS_Sinusoidal_WKT.c_str();
-				mo_NativeCRS.importFromWkt(&tmp);
+				ImportRegisteredCRS(mo_NativeCRS, tmp);
 				break;
 			}
 			case 97:// Cylindrical Equal Area (Grid corners set in meters for EASE grid)
 			case 98:// Cylindrical Equal Area (Grid corners set in DMS degs for EASE grid)
 			{
 				char *tmp = (char*) CEA_CRS_WKT.c_str();
-				mo_NativeCRS.importFromWkt(&tmp);
+				ImportRegisteredCRS(mo_NativeCRS, tmp);
 				break;
 			}
 			case 0:// Geographic
 			{
-				mo_NativeCRS.SetWellKnownGeogCS("WGS84");
+				ImportRegisteredCRS(mo_NativeCRS, "WGS84");
 				break;
 			}
 			default:
@@ -118,7 +118,11 @@ CPLErr HE5_SWATH_Dataset::InitialDataset(const int isSimple)
 	ms_SrcFilename = StrTrims(ms_SrcFilename, " \'\"");
 	ms_CoverageID = StrReplace(ms_CoverageID, "\'", "\"");
 
-	if (!isSimple)
+	//The geolocation fields are only decoded when their sidecar is missing
+	int bGeolCached = LoadGeolocationSidecar(isSimple ? "PARTIAL" : "FULL");
+	if (bGeolCached)
+		CPLSetConfigOption("GEOL_AS_GCPS", "NONE");
+	else if (!isSimple)
 		CPLSetConfigOption("GEOL_AS_GCPS", "FULL");
 	else
 		CPLSetConfigOption("GEOL_AS_GCPS", "PARTIAL");
@@ -157,6 +161,9 @@ CPLErr HE5_SWATH_Dataset::InitialDataset(const int isSimple)
 
 	maptrDS.reset(pSrc);
 
+	if (!bGeolCached)
+		SetGeolocationFromGCPs();
+
 	if (CE_None != SetNativeCRS() ||
 		CE_None != SetGeoTransform() ||
 		CE_None != SetGDALDataset(isSimple))
@@ -187,15 +194,15 @@ CPLErr HE5_SWATH_Dataset::SetNativeCRS()
 	if (CE_None == AbstractDataset::SetNativeCRS())
 		return CE_None;
 
-	char *psTargetSRS = (char*) maptrDS->GetGCPProjection();
-	if (psTargetSRS && *psTargetSRS != '\0')
+	const char *psTargetSRS = ms_GeolGCPProjection.c_str();
+	if (*psTargetSRS != '\0')
 	{
-		if (OGRERR_NONE != mo_NativeCRS.importFromWkt(&psTargetSRS))
-			mo_NativeCRS.SetWellKnownGeogCS("WGS84");
+		if (OGRERR_NONE != ImportRegisteredCRS(mo_NativeCRS, psTargetSRS))
+			ImportRegisteredCRS(mo_NativeCRS, "WGS84");
 	}
-	else if (maptrDS->GetGCPCount() > 0)
+	else if (mi_GeolGCPCount > 0)
 	{
-		mo_NativeCRS.SetWellKnownGeogCS("WGS84");
+		ImportRegisteredCRS(mo_NativeCRS, "WGS84");
 	}
 	else
 	{
@@ -264,13 +271,13 @@ CPLErr HE5_SWATH_Dataset::SetGeoTransform()
     }
     else //If failed to get bounding box from meta-data, then using GCPs
     {
-    	int nGCPs = maptrDS->GetGCPCount();
+    	int nGCPs = mi_GeolGCPCount;
 
     	OGRSpatialReference oGCPsSRS;
-    	char *psTargetSRS = (char*) maptrDS->GetGCPProjection();
-    	if (psTargetSRS && *psTargetSRS != '\0')
+    	const char *psTargetSRS = ms_GeolGCPProjection.c_str();
+    	if (*psTargetSRS != '\0')
     	{
-    		if (OGRERR_NONE != oGCPsSRS.importFromWkt(&psTargetSRS))
+    		if (OGRERR_NONE != ImportRegisteredCRS(oGCPsSRS, psTargetSRS))
     			oGCPsSRS = mo_NativeCRS;
     	}
     	else if (nGCPs > 0)
@@ -278,8 +285,7 @@ CPLErr HE5_SWATH_Dataset::SetGeoTransform()
     		oGCPsSRS = mo_NativeCRS;
     	}
 
-    	const GDAL_GCP* pGCPList = maptrDS->GetGCPs();
-    	if (nGCPs < 2 || NULL == pGCPList)
+    	if (nGCPs < 2)
     	{
     		md_Geotransform[0] = 0;
     		md_Geotransform[1] = 1;
@@ -292,10 +298,9 @@ CPLErr HE5_SWATH_Dataset::SetGeoTransform()
     		return CE_None;
     	}
 
-    	My2DPoint lowLeft;
-    	My2DPoint upRight;
-
-    	GetCornerPoints(pGCPList, nGCPs, lowLeft, upRight);
+    	//The corner points are derived once, with the GCPs or from the sidecar
+    	My2DPoint lowLeft = mo_GeolLowLeft;
+    	My2DPoint upRight = mo_GeolUpRight;
 
     	if (CE_None != bBox_transFormmate(oGCPsSRS, mo_NativeCRS, lowLeft, upRight))
     		return CE_Failure;
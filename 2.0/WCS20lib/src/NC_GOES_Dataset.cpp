@@ -28,14 +28,74 @@
  * DEALINGS IN THE SOFTWARE.
  ****************************************************************************/
 
+#include <unistd.h>
+//GDALTransformerInfo and GDAL_GTI2_SIGNATURE of the custom transformer, GDAL 2.2 or later
+#include <gdal_alg_priv.h>
 #include "NC_GOES_Dataset.h"
 
 using namespace std;
 
 #define GOES_TIME_DEBUG FALSE
 
+/* Longitude difference within -180 and 180 */
+static double WrapLongitude(double dfDX)
+{
+	return dfDX > 180.0 ? dfDX - 360.0 : (dfDX < -180.0 ? dfDX + 360.0 : dfDX);
+}
+
+/* Transformer between the rectified grid and the GOES image, through the lat/lon lookup index */
+typedef struct
+{
+	GDALTransformerInfo sTI;
+	NC_GOES_Dataset* poDS;
+	double adfDstGeoTransform[6];
+	double adfDstInvGeoTransform[6];
+} GOESIndexTransformInfo;
+
+static int GOESIndexTransform(void* pTransformArg, int bDstToSrc, int nPointCount,
+		double* x, double* y, double* z, int* panSuccess)
+{
+	GOESIndexTransformInfo* psInfo = (GOESIndexTransformInfo*) pTransformArg;
+	for (int i = 0; i < nPointCount; i++)
+	{
+		double dfPixel, dfLine, dfLon, dfLat;
+		if (bDstToSrc)
+		{
+			GDALApplyGeoTransform(psInfo->adfDstGeoTransform, x[i], y[i], &dfLon, &dfLat);
+			panSuccess[i] = psInfo->poDS->GetPixelOfLatLon(dfLon, dfLat, dfPixel, dfLine);
+			if (panSuccess[i])
+			{
+				//The index has the center of the pixels at integer coordinates
+				x[i] = dfPixel + 0.5;
+				y[i] = dfLine + 0.5;
+			}
+		}
+		else
+		{
+			panSuccess[i] = psInfo->poDS->GetLatLonOfPixel(x[i] - 0.5, y[i] - 0.5, dfLon, dfLat);
+			if (panSuccess[i])
+			{
+				double dfWest = psInfo->adfDstGeoTransform[0];
+				dfLon = dfWest + fmod(fmod(dfLon - dfWest, 360.0) + 360.0, 360.0);
+				GDALApplyGeoTransform(psInfo->adfDstInvGeoTransform, dfLon, dfLat, x + i, y + i);
+			}
+		}
+	}
+
+	return TRUE;
+}
+
+static void GOESIndexTransformCleanup(void* pTransformArg)
+{
+	CPLFree(pTransformArg);
+}
+
 NC_GOES_Dataset::NC_GOES_Dataset()
 {
+	mi_IndexCols = 0;
+	mi_IndexRows = 0;
+	mi_BucketsX = 0;
+	mi_BucketsY = 0;
 }
 
 /************************************************************************/
@@ -51,6 +111,9 @@ NC_GOES_Dataset::NC_GOES_Dataset()
 
 NC_GOES_Dataset::~NC_GOES_Dataset()
 {
+	//The warped dataset is closed while the lat/lon lookup index of its transformer is alive
+	if (maptrDS.get())
+		GDALClose(maptrDS.release());
 }
 
 /************************************************************************/
@@ -77,6 +140,10 @@ NC_GOES_Dataset::NC_GOES_Dataset(const string& id, vector<int> &rBandList) :
 {
 	md_MissingValue = 0;
 	mb_GeoTransformSet = FALSE;
+	mi_IndexCols = 0;
+	mi_IndexRows = 0;
+	mi_BucketsX = 0;
+	mi_BucketsY = 0;
 }
 
 /************************************************************************/
@@ -196,7 +263,7 @@ CPLErr NC_GOES_Dataset::SetNativeCRS()
 		return CE_Failure;
 	}
 
-	mo_NativeCRS.SetWellKnownGeogCS("WGS84");
+	ImportRegisteredCRS(mo_NativeCRS, "WGS84");
 
 	GDALClose(hLatDS);
 	GDALClose(hLonDS);
@@ -274,8 +341,9 @@ CPLErr NC_GOES_Dataset::setResampleStandard(GDALDataset* hSrcDS, int& xRSValue,
 /**
  * \brief Set the native geographical bounding box and GCP array for a GOES data.
  *
- * The method will set the native geographical bounding box
- * by comparing the coordinates values existed in longitude and latitude field.
+ * The method will set the native geographical bounding box and the GCPs
+ * from the nodes of the lat/lon lookup index of the GOES fixed grid, see
+ * LoadLatLonIndex().
  *
  * @param poVDS The GDAL dataset returned by calling GDALOpen() method.
  *
@@ -309,92 +377,504 @@ CPLErr NC_GOES_Dataset::SetGeoBBoxAndGCPs(GDALDataset* poVDS)
 		return CE_Failure;
 	}
 
-	/*
-	*	Re-sample Standards:
-	*	Height | Width
-	*	(0, 500)		every other one pixel
-	*	[500, 1000)		every other two pixels
-	*	[1000,1500)		every other three pixels
-	*	[1500,2000)		every other four pixels
-	*	... ...
-	*/
-
-	int xSpace = 1;
-	int ySpace = 1;
-	setResampleStandard(poVDS, xSpace, ySpace);
-
-	int nGCPs = 0;
-	GDAL_GCP gdalCGP;
-
-	GDALRasterBand *poBandLat = hLatDS->GetRasterBand(1);
-	GDALRasterBand *poBandLon = hLonDS->GetRasterBand(1);
-	GDALDataType eDT = poBandLat->GetRasterDataType();
-	void *dataLat = NULL;
-	void *dataLon = NULL;
+	CPLErr eErr = LoadLatLonIndex(hLatDS->GetRasterBand(1), hLonDS->GetRasterBand(1));
+	GDALClose(hLatDS);
+	GDALClose(hLonDS);
+	if (CE_None != eErr)
+		return CE_Failure;
 
+	//The GCPs are copied by SetGCPs(), they share empty identifiers
+	static char szEmpty[] = "";
 	mdSrcGeoMinX = 360;
 	mdSrcGeoMaxX = -360;
 	mdSrcGeoMinY = 90;
 	mdSrcGeoMaxY = -90;
-
-	switch (eDT)
+	m_gdalGCPs.clear();
+	for (int iRow = 0; iRow < mi_IndexRows; iRow++)
 	{
-	case GDT_Float32: //For GOES Imager and Sounder data
+		for (int iCol = 0; iCol < mi_IndexCols; iCol++)
+		{
+			double x = mv_IndexLonLat[2 * (iRow * mi_IndexCols + iCol)];
+			double y = mv_IndexLonLat[2 * (iRow * mi_IndexCols + iCol) + 1];
+			if (x == -999)
+				continue;
+			GDAL_GCP gdalCGP;
+			gdalCGP.pszId = szEmpty;
+			gdalCGP.pszInfo = szEmpty;
+			gdalCGP.dfGCPLine = MIN(iRow * mi_IndexStepY, nYSize - 1);
+			gdalCGP.dfGCPPixel = MIN(iCol * mi_IndexStepX, nXSize - 1);
+			gdalCGP.dfGCPX = x;
+			gdalCGP.dfGCPY = y;
+			gdalCGP.dfGCPZ = 0;
+			m_gdalGCPs.push_back(gdalCGP);
+			mdSrcGeoMinX = MIN(mdSrcGeoMinX, x);
+			mdSrcGeoMaxX = MAX(mdSrcGeoMaxX, x);
+			mdSrcGeoMinY = MIN(mdSrcGeoMinY, y);
+			mdSrcGeoMaxY = MAX(mdSrcGeoMaxY, y);
+		}
+	}
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                           LoadLatLonIndex()                          */
+/************************************************************************/
+
+/**
+ * \brief Load the lat/lon lookup index of the GOES fixed grid.
+ *
+ * The latitude/longitude fields only depend on the position of the
+ * satellite and the scan mode, so the index is shared by all the files of
+ * the same fixed grid. It is keyed by the size of the grid and a sample of
+ * three lines of the fields, and stored in the directory given by the
+ * WCS_GEOLOCATION_CACHE configuration option. It is built by
+ * BuildLatLonIndex() when it is not found, or not configured, and rebuilt
+ * when its header does not match the grid, e.g. the number of nodes for
+ * the sampling steps, or the file is not as large as its arrays.
+ *
+ * The layout of the index file, in the byte order of the server:
+ *
+ *   0  char[8]   magic, "WCSGOES1"
+ *   8  int32[10] image width and height, sampling steps, nodes, buckets,
+ *                wrap flag and zero
+ *  48  double[3] origin and size of the buckets
+ *  72  float[2]  longitude and latitude of each node
+ *      int32[4]  window of each bucket
+ *      float[2]  mean pixel and line of each bucket
+ *
+ * @param poBandLat The latitude band.
+ *
+ * @param poBandLon The longitude band.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr NC_GOES_Dataset::LoadLatLonIndex(GDALRasterBand* poBandLat, GDALRasterBand* poBandLon)
+{
+	int nXSize = poBandLat->GetXSize();
+	int nYSize = poBandLat->GetYSize();
+	setResampleStandard(maptrDS.get(), mi_IndexStepX, mi_IndexStepY);
+
+	const char* pszCacheDir = CPLGetConfigOption("WCS_GEOLOCATION_CACHE", NULL);
+	if (!pszCacheDir || *pszCacheDir == '\0')
+		return BuildLatLonIndex(poBandLat, poBandLon);
+
+	//The fixed grid is identified by its first, middle and last lines
+	string sKey = CPLString().Printf("GOES\n%d %d %d %d", nXSize, nYSize, mi_IndexStepX, mi_IndexStepY);
+	vector<float> afLat(nXSize), afLon(nXSize);
+	int anLines[3] = {0, nYSize / 2, nYSize - 1};
+	for (int i = 0; i < 3; i++)
 	{
-		dataLat = (float *) CPLMalloc(nXSize * sizeof(float));
-		dataLon = (float *) CPLMalloc(nXSize * sizeof(float));
+		if (CE_None != poBandLat->RasterIO(GF_Read, 0, anLines[i], nXSize, 1, &afLat[0], nXSize, 1, GDT_Float32, 0, 0) ||
+			CE_None != poBandLon->RasterIO(GF_Read, 0, anLines[i], nXSize, 1, &afLon[0], nXSize, 1, GDT_Float32, 0, 0))
+			return BuildLatLonIndex(poBandLat, poBandLon);
+		for (int iPixel = 0; iPixel < nXSize; iPixel += 16)
+			sKey += CPLString().Printf(" %.4f,%.4f", afLon[iPixel], afLat[iPixel]);
+	}
+
+	VSIStatBufL sStat;
+	if (VSIStatL(pszCacheDir, &sStat) != 0)
+		VSIMkdir(pszCacheDir, 0755);
+	string sIndexName = CPLFormFilename(pszCacheDir, GetStringHash(sKey).c_str(), "goesidx");
 
-		for (int iLine = 0; iLine < nYSize; iLine += ySpace)
+	VSILFILE* fp = VSIFOpenL(sIndexName.c_str(), "rb");
+	if (fp)
+	{
+		char abyHeader[72];
+		GInt32 anHeader[10];
+		double adfBuckets[3];
+		int bOK = VSIFReadL(abyHeader, 72, 1, fp) == 1 && memcmp(abyHeader, "WCSGOES1", 8) == 0;
+		if (bOK)
+		{
+			memcpy(anHeader, abyHeader + 8, 40);
+			memcpy(adfBuckets, abyHeader + 48, 24);
+			//The nodes are those built for the grid, and the file holds all the arrays, otherwise it is rebuilt
+			int nIndexCols = mi_IndexStepX > 0 ? (nXSize - 1 + mi_IndexStepX - 1) / mi_IndexStepX + 1 : 0;
+			int nIndexRows = mi_IndexStepY > 0 ? (nYSize - 1 + mi_IndexStepY - 1) / mi_IndexStepY + 1 : 0;
+			bOK = anHeader[0] == nXSize && anHeader[1] == nYSize && anHeader[2] == mi_IndexStepX &&
+					anHeader[3] == mi_IndexStepY && anHeader[4] == nIndexCols && anHeader[5] == nIndexRows &&
+					nIndexCols > 1 && nIndexRows > 1 &&
+					anHeader[6] > 0 && anHeader[7] > 0 && (double)anHeader[6] * anHeader[7] <= 1048576 &&
+					adfBuckets[2] > 0 && CPLIsFinite(adfBuckets[0]) && CPLIsFinite(adfBuckets[1]) && CPLIsFinite(adfBuckets[2]);
+		}
+		if (bOK)
 		{
-			if (iLine >= nYSize)
-				iLine = nYSize - 1;
+			vsi_l_offset nExpectedSize = 72 + (vsi_l_offset)(2 * sizeof(float)) * anHeader[4] * anHeader[5] +
+					(vsi_l_offset)(4 * sizeof(GInt32) + 2 * sizeof(float)) * anHeader[6] * anHeader[7];
+			VSIStatBufL sIndexStat;
+			bOK = VSIStatL(sIndexName.c_str(), &sIndexStat) == 0 && (vsi_l_offset)sIndexStat.st_size == nExpectedSize;
+		}
+		if (bOK)
+		{
+			mi_IndexCols = anHeader[4];
+			mi_IndexRows = anHeader[5];
+			mi_BucketsX = anHeader[6];
+			mi_BucketsY = anHeader[7];
+			mb_BucketsWrap = anHeader[8];
+			md_BucketMinX = adfBuckets[0];
+			md_BucketMinY = adfBuckets[1];
+			md_BucketSize = adfBuckets[2];
+			size_t nBuckets = (size_t)mi_BucketsX * mi_BucketsY;
+			mv_IndexLonLat.resize(2 * (size_t)mi_IndexCols * mi_IndexRows);
+			mv_BucketWindow.resize(4 * nBuckets);
+			mv_BucketCenter.resize(2 * nBuckets);
+			bOK = VSIFReadL(&mv_IndexLonLat[0], mv_IndexLonLat.size() * sizeof(float), 1, fp) == 1 &&
+					VSIFReadL(&mv_BucketWindow[0], mv_BucketWindow.size() * sizeof(GInt32), 1, fp) == 1 &&
+					VSIFReadL(&mv_BucketCenter[0], mv_BucketCenter.size() * sizeof(float), 1, fp) == 1;
+		}
+		VSIFCloseL(fp);
+		if (bOK)
+			return CE_None;
+	}
+
+	if (CE_None != BuildLatLonIndex(poBandLat, poBandLon))
+		return CE_Failure;
+
+	//Written to a temporary file then renamed, the concurrent readers never see a partial index
+	char abyHeader[72];
+	GInt32 anHeader[10] = {nXSize, nYSize, mi_IndexStepX, mi_IndexStepY, mi_IndexCols, mi_IndexRows,
+			mi_BucketsX, mi_BucketsY, mb_BucketsWrap, 0};
+	double adfBuckets[3] = {md_BucketMinX, md_BucketMinY, md_BucketSize};
+	memcpy(abyHeader, "WCSGOES1", 8);
+	memcpy(abyHeader + 8, anHeader, 40);
+	memcpy(abyHeader + 48, adfBuckets, 24);
+
+	string sTmpName = sIndexName + CPLString().Printf(".%d.tmp", (int)getpid());
+	fp = VSIFOpenL(sTmpName.c_str(), "wb");
+	if (!fp)
+		return CE_None;
+	int bOK = VSIFWriteL(abyHeader, 72, 1, fp) == 1 &&
+			VSIFWriteL(&mv_IndexLonLat[0], mv_IndexLonLat.size() * sizeof(float), 1, fp) == 1 &&
+			VSIFWriteL(&mv_BucketWindow[0], mv_BucketWindow.size() * sizeof(GInt32), 1, fp) == 1 &&
+			VSIFWriteL(&mv_BucketCenter[0], mv_BucketCenter.size() * sizeof(float), 1, fp) == 1;
+	VSIFCloseL(fp);
+	if (!bOK || VSIRename(sTmpName.c_str(), sIndexName.c_str()) != 0)
+		VSIUnlink(sTmpName.c_str());
+
+	return CE_None;
+}
 
-			poBandLat->RasterIO(GF_Read, 0, iLine, nXSize, 1, dataLat, nXSize, 1, GDT_Float32, 0, 0);
-			poBandLon->RasterIO(GF_Read, 0, iLine, nXSize, 1, dataLon, nXSize, 1, GDT_Float32, 0, 0);
+/************************************************************************/
+/*                          BuildLatLonIndex()                          */
+/************************************************************************/
+
+/**
+ * \brief Build the lat/lon lookup index of the GOES fixed grid.
+ *
+ * The latitude/longitude fields are sampled every few lines and pixels
+ * (see setResampleStandard()) into a grid of nodes, the last line and
+ * pixel included. The bounding box of the nodes is divided into square
+ * buckets, about two nodes wide, and each cell of the grid extends the
+ * window and the mean pixel and line of the buckets it overlaps. When
+ * the fixed grid crosses the antimeridian, the buckets span 360 degrees
+ * of longitude.
+ *
+ * @param poBandLat The latitude band.
+ *
+ * @param poBandLon The longitude band.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr NC_GOES_Dataset::BuildLatLonIndex(GDALRasterBand* poBandLat, GDALRasterBand* poBandLon)
+{
+	int nXSize = poBandLat->GetXSize();
+	int nYSize = poBandLat->GetYSize();
+	mi_IndexCols = (nXSize - 1 + mi_IndexStepX - 1) / mi_IndexStepX + 1;
+	mi_IndexRows = (nYSize - 1 + mi_IndexStepY - 1) / mi_IndexStepY + 1;
+	if (nXSize < 2 || nYSize < 2)
+	{
+		SetWCS_ErrorLocator("NC_GOES_Dataset::BuildLatLonIndex()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "The latitude/longitude fields are too small.");
+		return CE_Failure;
+	}
 
-			for (int iPixel = 0; iPixel < nXSize; iPixel += xSpace)
+	//step 1: the sampled nodes
+	mv_IndexLonLat.assign(2 * (size_t)mi_IndexCols * mi_IndexRows, -999);
+	vector<float> afLat(nXSize), afLon(nXSize);
+	double dfMinX = 360, dfMaxX = -360, dfMinY = 90, dfMaxY = -90;
+	for (int iRow = 0; iRow < mi_IndexRows; iRow++)
+	{
+		int iLine = MIN(iRow * mi_IndexStepY, nYSize - 1);
+		if (CE_None != poBandLat->RasterIO(GF_Read, 0, iLine, nXSize, 1, &afLat[0], nXSize, 1, GDT_Float32, 0, 0) ||
+			CE_None != poBandLon->RasterIO(GF_Read, 0, iLine, nXSize, 1, &afLon[0], nXSize, 1, GDT_Float32, 0, 0))
+		{
+			SetWCS_ErrorLocator("NC_GOES_Dataset::BuildLatLonIndex()");
+			WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to read the latitude/longitude fields.");
+			return CE_Failure;
+		}
+		for (int iCol = 0; iCol < mi_IndexCols; iCol++)
+		{
+			int iPixel = MIN(iCol * mi_IndexStepX, nXSize - 1);
+			double x = afLon[iPixel];
+			double y = afLat[iPixel];
+			if (!isValidLongitude(x) || !isValidLatitude(y))
+				continue;
+			mv_IndexLonLat[2 * (iRow * mi_IndexCols + iCol)] = (float)x;
+			mv_IndexLonLat[2 * (iRow * mi_IndexCols + iCol) + 1] = (float)y;
+			dfMinX = MIN(dfMinX, x);
+			dfMaxX = MAX(dfMaxX, x);
+			dfMinY = MIN(dfMinY, y);
+			dfMaxY = MAX(dfMaxY, y);
+		}
+	}
+	if (dfMinX > dfMaxX)
+	{
+		SetWCS_ErrorLocator("NC_GOES_Dataset::BuildLatLonIndex()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "The latitude/longitude fields have no valid coordinate.");
+		return CE_Failure;
+	}
+
+	//step 2: the cells of the grid, with their longitudes unwrapped across the antimeridian
+	mb_BucketsWrap = FALSE;
+	for (int iRow = 0; iRow + 1 < mi_IndexRows && !mb_BucketsWrap; iRow++)
+	{
+		for (int iCol = 0; iCol + 1 < mi_IndexCols; iCol++)
+		{
+			float fX0 = mv_IndexLonLat[2 * (iRow * mi_IndexCols + iCol)];
+			float fX1 = mv_IndexLonLat[2 * (iRow * mi_IndexCols + iCol + 1)];
+			if (fX0 != -999 && fX1 != -999 && fabs(fX1 - fX0) > 180.0)
+			{
+				mb_BucketsWrap = TRUE;
+				break;
+			}
+		}
+	}
+	md_BucketSize = 2.0 * (dfMaxY - dfMinY) / mi_IndexRows;
+	if (mb_BucketsWrap)
+	{
+		dfMinX = -180.0;
+		dfMaxX = 180.0;
+	}
+	else
+		md_BucketSize = MAX(md_BucketSize, 2.0 * (dfMaxX - dfMinX) / mi_IndexCols);
+	md_BucketSize = MAX(md_BucketSize, sqrt((dfMaxX - dfMinX) * (dfMaxY - dfMinY) / 1048576.0));
+	md_BucketSize = MAX(md_BucketSize, 1e-3);
+	if (mb_BucketsWrap)//whole buckets in 360 degrees, wrapped by a modulo
+		md_BucketSize = 360.0 / ceil(360.0 / md_BucketSize);
+	md_BucketMinX = dfMinX;
+	md_BucketMinY = dfMinY;
+	mi_BucketsX = MAX(1, (int)ceil((dfMaxX - dfMinX) / md_BucketSize));
+	mi_BucketsY = MAX(1, (int)ceil((dfMaxY - dfMinY) / md_BucketSize));
+	size_t nBuckets = (size_t)mi_BucketsX * mi_BucketsY;
+	mv_BucketWindow.assign(4 * nBuckets, -1);
+	mv_BucketCenter.assign(2 * nBuckets, 0);
+	vector<int> anBucketCells(nBuckets, 0);
+
+	for (int iRow = 0; iRow + 1 < mi_IndexRows; iRow++)
+	{
+		int nLine0 = MIN(iRow * mi_IndexStepY, nYSize - 1);
+		int nLine1 = MIN((iRow + 1) * mi_IndexStepY, nYSize - 1);
+		for (int iCol = 0; iCol + 1 < mi_IndexCols; iCol++)
+		{
+			int nPixel0 = MIN(iCol * mi_IndexStepX, nXSize - 1);
+			int nPixel1 = MIN((iCol + 1) * mi_IndexStepX, nXSize - 1);
+			int anNodes[4] = {iRow * mi_IndexCols + iCol, iRow * mi_IndexCols + iCol + 1,
+					(iRow + 1) * mi_IndexCols + iCol, (iRow + 1) * mi_IndexCols + iCol + 1};
+			double dfCellMinX = 0, dfCellMaxX = 0, dfCellMinY = 0, dfCellMaxY = 0;
+			int bValid = TRUE;
+			for (int k = 0; k < 4 && bValid; k++)
+			{
+				double x = mv_IndexLonLat[2 * anNodes[k]];
+				double y = mv_IndexLonLat[2 * anNodes[k] + 1];
+				bValid = x != -999;
+				if (k > 0)
+					x = mv_IndexLonLat[2 * anNodes[0]] + WrapLongitude(x - mv_IndexLonLat[2 * anNodes[0]]);
+				dfCellMinX = k == 0 ? x : MIN(dfCellMinX, x);
+				dfCellMaxX = k == 0 ? x : MAX(dfCellMaxX, x);
+				dfCellMinY = k == 0 ? y : MIN(dfCellMinY, y);
+				dfCellMaxY = k == 0 ? y : MAX(dfCellMaxY, y);
+			}
+			if (!bValid)
+				continue;
+
+			int nBY0 = MAX(0, (int)floor((dfCellMinY - md_BucketMinY) / md_BucketSize));
+			int nBY1 = MIN(mi_BucketsY - 1, (int)floor((dfCellMaxY - md_BucketMinY) / md_BucketSize));
+			int nBX0 = (int)floor((dfCellMinX - md_BucketMinX) / md_BucketSize);
+			int nBX1 = (int)floor((dfCellMaxX - md_BucketMinX) / md_BucketSize);
+			if (!mb_BucketsWrap)
 			{
-				if(iPixel >= nXSize)
-					iPixel = nXSize - 1;
-				double x = *((float *) dataLon + iPixel);
-				double y = *((float *) dataLat + iPixel);
-				if (isValidLongitude(x) && isValidLatitude(y))
+				nBX0 = MAX(0, nBX0);
+				nBX1 = MIN(mi_BucketsX - 1, nBX1);
+			}
+			for (int nBY = nBY0; nBY <= nBY1; nBY++)
+			{
+				for (int nBXU = nBX0; nBXU <= nBX1 && nBXU < nBX0 + mi_BucketsX; nBXU++)
 				{
-					char pChr[64];
-					sprintf(pChr, "%d", ++nGCPs);
-					GDALInitGCPs(1, &gdalCGP);
-					gdalCGP.pszId = strdup(pChr);
-					gdalCGP.pszInfo = strdup("");
-					gdalCGP.dfGCPLine = iLine;
-					gdalCGP.dfGCPPixel = iPixel;
-					gdalCGP.dfGCPX = x;
-					gdalCGP.dfGCPY = y;
-					gdalCGP.dfGCPZ = 0;
-					m_gdalGCPs.push_back(gdalCGP);
-					mdSrcGeoMinX = MIN(mdSrcGeoMinX,gdalCGP.dfGCPX );
-					mdSrcGeoMaxX = MAX(mdSrcGeoMaxX,gdalCGP.dfGCPX);
-					mdSrcGeoMinY = MIN(mdSrcGeoMinY,gdalCGP.dfGCPY);
-					mdSrcGeoMaxY = MAX(mdSrcGeoMaxY,gdalCGP.dfGCPY);
+					int nBX = ((nBXU % mi_BucketsX) + mi_BucketsX) % mi_BucketsX;
+					size_t iBucket = (size_t)nBY * mi_BucketsX + nBX;
+					GInt32* panWindow = &mv_BucketWindow[4 * iBucket];
+					if (anBucketCells[iBucket] == 0)
+					{
+						panWindow[0] = nPixel0;
+						panWindow[1] = nLine0;
+						panWindow[2] = nPixel1;
+						panWindow[3] = nLine1;
+					}
+					else
+					{
+						panWindow[0] = MIN(panWindow[0], nPixel0);
+						panWindow[1] = MIN(panWindow[1], nLine0);
+						panWindow[2] = MAX(panWindow[2], nPixel1);
+						panWindow[3] = MAX(panWindow[3], nLine1);
+					}
+					mv_BucketCenter[2 * iBucket] += 0.5f * (nPixel0 + nPixel1);
+					mv_BucketCenter[2 * iBucket + 1] += 0.5f * (nLine0 + nLine1);
+					anBucketCells[iBucket]++;
 				}
 			}
 		}
+	}
+	for (size_t iBucket = 0; iBucket < nBuckets; iBucket++)
+	{
+		if (anBucketCells[iBucket] > 0)
+		{
+			mv_BucketCenter[2 * iBucket] /= anBucketCells[iBucket];
+			mv_BucketCenter[2 * iBucket + 1] /= anBucketCells[iBucket];
+		}
+	}
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                          GetLatLonOfPixel()                          */
+/************************************************************************/
+
+/**
+ * \brief Get the coordinates of a pixel from the lat/lon lookup index.
+ *
+ * The coordinates are interpolated bilinearly between the nodes around
+ * the pixel, the center of the pixel being at integer coordinates.
+ *
+ * @param dfPixel The pixel.
+ *
+ * @param dfLine The line.
+ *
+ * @param dfLon The longitude of the pixel, unwrapped from the longitude of
+ * the nearest node, within -540 and 540.
+ *
+ * @param dfLat The latitude of the pixel.
+ *
+ * @return TRUE on success, FALSE if the pixel is not on the earth.
+ */
 
-		VSIFree((float *) dataLat);
-		VSIFree((float *) dataLon);
+int NC_GOES_Dataset::GetLatLonOfPixel(double dfPixel, double dfLine, double& dfLon, double& dfLat)
+{
+	if (mi_IndexCols < 2 || mi_IndexRows < 2 || dfPixel < -0.5 || dfLine < -0.5 ||
+		dfPixel > mi_GoesSrcImageXSize - 0.5 || dfLine > mi_GoesSrcImageYSize - 0.5)
+		return FALSE;
+
+	int iCol = MAX(0, MIN(mi_IndexCols - 2, (int)(dfPixel / mi_IndexStepX)));
+	int iRow = MAX(0, MIN(mi_IndexRows - 2, (int)(dfLine / mi_IndexStepY)));
+	double dfPixel0 = iCol * mi_IndexStepX;
+	double dfLine0 = iRow * mi_IndexStepY;
+	double dfT = (dfPixel - dfPixel0) / (MIN((iCol + 1) * mi_IndexStepX, mi_GoesSrcImageXSize - 1) - dfPixel0);
+	double dfU = (dfLine - dfLine0) / (MIN((iRow + 1) * mi_IndexStepY, mi_GoesSrcImageYSize - 1) - dfLine0);
+
+	const float* pafNode00 = &mv_IndexLonLat[2 * (iRow * mi_IndexCols + iCol)];
+	const float* pafNode10 = pafNode00 + 2 * mi_IndexCols;
+	double adfLon[4] = {pafNode00[0], pafNode00[2], pafNode10[0], pafNode10[2]};
+	double adfLat[4] = {pafNode00[1], pafNode00[3], pafNode10[1], pafNode10[3]};
+	for (int k = 0; k < 4; k++)
+	{
+		if (adfLon[k] == -999)
+			return FALSE;
+		if (k > 0)
+			adfLon[k] = adfLon[0] + WrapLongitude(adfLon[k] - adfLon[0]);
 	}
-		break;
+	dfLon = (1 - dfU) * ((1 - dfT) * adfLon[0] + dfT * adfLon[1]) + dfU * ((1 - dfT) * adfLon[2] + dfT * adfLon[3]);
+	dfLat = (1 - dfU) * ((1 - dfT) * adfLat[0] + dfT * adfLat[1]) + dfU * ((1 - dfT) * adfLat[2] + dfT * adfLat[3]);
 
-	default:
-		break;
+	return TRUE;
+}
+
+/************************************************************************/
+/*                          GetPixelOfLatLon()                          */
+/************************************************************************/
+
+/**
+ * \brief Get the pixel at some coordinates from the lat/lon lookup index.
+ *
+ * The bucket of the coordinates, or the nearest bucket within two buckets,
+ * gives the mean pixel and line of its cells as the first guess, which is
+ * refined by a few Newton iterations on GetLatLonOfPixel(). The number of
+ * operations does not depend on the size of the grid.
+ *
+ * @param dfLon The longitude.
+ *
+ * @param dfLat The latitude.
+ *
+ * @param dfPixel The pixel at the coordinates, the center of the pixel being
+ * at integer coordinates.
+ *
+ * @param dfLine The line at the coordinates.
+ *
+ * @return TRUE on success, FALSE if the coordinates are not in the grid.
+ */
+
+int NC_GOES_Dataset::GetPixelOfLatLon(double dfLon, double dfLat, double& dfPixel, double& dfLine)
+{
+	if (mi_BucketsX < 1 || mi_BucketsY < 1)
+		return FALSE;
+	dfLon = fmod(dfLon + 180.0, 360.0);
+	dfLon += dfLon < 0 ? 180.0 : -180.0;
+
+	int nBX = (int)floor((dfLon - md_BucketMinX) / md_BucketSize);
+	int nBY = (int)floor((dfLat - md_BucketMinY) / md_BucketSize);
+	int iBucket = -1;
+	for (int nRing = 0; nRing <= 2 && iBucket < 0; nRing++)
+	{
+		for (int nDY = -nRing; nDY <= nRing && iBucket < 0; nDY++)
+		{
+			for (int nDX = -nRing; nDX <= nRing && iBucket < 0; nDX++)
+			{
+				if (MAX(abs(nDX), abs(nDY)) != nRing)
+					continue;
+				int nX = nBX + nDX, nY = nBY + nDY;
+				if (mb_BucketsWrap)
+					nX = ((nX % mi_BucketsX) + mi_BucketsX) % mi_BucketsX;
+				if (nX < 0 || nX >= mi_BucketsX || nY < 0 || nY >= mi_BucketsY)
+					continue;
+				if (mv_BucketWindow[4 * ((size_t)nY * mi_BucketsX + nX)] >= 0)
+					iBucket = nY * mi_BucketsX + nX;
+			}
+		}
 	}
+	if (iBucket < 0)
+		return FALSE;
 
-	GDALClose(hLatDS);
-	GDALClose(hLonDS);
+	dfPixel = mv_BucketCenter[2 * iBucket];
+	dfLine = mv_BucketCenter[2 * iBucket + 1];
+	double dfMaxPixel = mi_GoesSrcImageXSize - 1, dfMaxLine = mi_GoesSrcImageYSize - 1;
+	for (int nIter = 0; nIter < 10; nIter++)
+	{
+		double dfX, dfY, dfXP, dfYP, dfXL, dfYL;
+		double dfStepP = dfPixel < dfMaxPixel ? 1.0 : -1.0;
+		double dfStepL = dfLine < dfMaxLine ? 1.0 : -1.0;
+		if (!GetLatLonOfPixel(dfPixel, dfLine, dfX, dfY) ||
+			!GetLatLonOfPixel(dfPixel + dfStepP, dfLine, dfXP, dfYP) ||
+			!GetLatLonOfPixel(dfPixel, dfLine + dfStepL, dfXL, dfYL))
+			return FALSE;
+		double dfDX = WrapLongitude(dfLon - dfX);
+		double dfDY = dfLat - dfY;
+		double dfA = WrapLongitude(dfXP - dfX) / dfStepP, dfB = WrapLongitude(dfXL - dfX) / dfStepL;
+		double dfC = (dfYP - dfY) / dfStepP, dfD = (dfYL - dfY) / dfStepL;
+		double dfDet = dfA * dfD - dfB * dfC;
+		if (dfDet == 0)
+			return FALSE;
+		double dfDP = (dfD * dfDX - dfB * dfDY) / dfDet;
+		double dfDL = (dfA * dfDY - dfC * dfDX) / dfDet;
+		dfPixel = MAX(0.0, MIN(dfMaxPixel, dfPixel + dfDP));
+		dfLine = MAX(0.0, MIN(dfMaxLine, dfLine + dfDL));
+		if (fabs(dfDP) + fabs(dfDL) < 0.01)
+			return TRUE;
+	}
 
-	return CE_None;
+	return FALSE;
 }
 
-
 /************************************************************************/
 /*                           SetGDALDataset()                           */
 /************************************************************************/
@@ -567,59 +1047,111 @@ CPLErr NC_GOES_Dataset::GetGeoMinMax(double geoMinMax[])
 }
 
 /************************************************************************/
-/*                          GetGeoMinMax()                              */
+/*                         RectifyGOESDataSet()                         */
 /************************************************************************/
 
 /**
  * \brief Convert the GOES dataset from satellite CRS project to grid CRS.
  *
- * The method will convert the GOES dataset from satellite CRS project to
- * grid CRS based on GDAL API GDALReprojectImage;
+ * The method will replace the GOES dataset by a warped VRT dataset on the
+ * rectified grid, so that only the blocks read by GetCoverage, and the
+ * source windows mapping to them, are rectified rather than the whole scan.
+ * The transformer of the warped VRT is the lat/lon lookup index, see
+ * LoadLatLonIndex(): GetPixelOfLatLon() maps the cells of each block back to
+ * the GOES image, which also gives the source window of the block, and
+ * GetLatLonOfPixel() maps the GOES pixels forward. The index is looked up
+ * through an approximating transformer, with an error threshold of 0.125
+ * pixel, which only transforms some points of each row exactly and
+ * interpolates the others.
+ *
+ * The custom transformer needs GDAL 2.2 or later, for GDAL_GTI2_SIGNATURE in
+ * gdal_alg_priv.h.
  *
  * @return CE_None on success or CE_Failure on failure.
  */
 
 CPLErr NC_GOES_Dataset::RectifyGOESDataSet()
 {
-	char *pszDstWKT;
-	mo_NativeCRS.exportToWkt(&pszDstWKT);
-
-	GDALDriverH poDriver = GDALGetDriverByName("MEM");
-	GDALDataset* rectDataSet = (GDALDataset*) GDALCreate(poDriver, "", mi_RectifiedImageXSize,
-			mi_RectifiedImageYSize, maptrDS->GetRasterCount(),
-			maptrDS->GetRasterBand(1)->GetRasterDataType(), NULL);
-	if (NULL == rectDataSet)
+	if (mi_BucketsX < 1 || mi_BucketsY < 1)
 	{
-		GDALClose(poDriver);
-		OGRFree(pszDstWKT);
-		SetWCS_ErrorLocator("AbstractDataset::rectifyDataSet()");
-		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode,
-				"Failed to create \"MEM\" dataSet.");
-
+		SetWCS_ErrorLocator("NC_GOES_Dataset::RectifyGOESDataSet()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "The lat/lon lookup index is not available.");
 		return CE_Failure;
 	}
 
-	rectDataSet->SetProjection(pszDstWKT);
-	rectDataSet->SetGeoTransform(md_Geotransform);
+	//step 1: the transformer from the lat/lon lookup index, approximated along the rows, both destroyed
+	//with the warped VRT dataset
+	GOESIndexTransformInfo* psInfo = (GOESIndexTransformInfo*) CPLCalloc(1, sizeof(GOESIndexTransformInfo));
+	memcpy(psInfo->sTI.abySignature, GDAL_GTI2_SIGNATURE, GDAL_GTI2_SIGNATURE_LEN);
+	psInfo->sTI.pszClassName = "GOESIndexTransformer";
+	psInfo->sTI.pfnTransform = GOESIndexTransform;
+	psInfo->sTI.pfnCleanup = GOESIndexTransformCleanup;
+	psInfo->poDS = this;
+	memcpy(psInfo->adfDstGeoTransform, md_Geotransform, sizeof(md_Geotransform));
+	if (!GDALInvGeoTransform(psInfo->adfDstGeoTransform, psInfo->adfDstInvGeoTransform))
+	{
+		CPLFree(psInfo);
+		SetWCS_ErrorLocator("NC_GOES_Dataset::RectifyGOESDataSet()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "The geotransform of the rectified grid is not invertible.");
+		return CE_Failure;
+	}
+	void* hTransformArg = GDALCreateApproxTransformer(GOESIndexTransform, psInfo, 0.125);
+	if (NULL == hTransformArg)
+	{
+		CPLFree(psInfo);
+		SetWCS_ErrorLocator("NC_GOES_Dataset::RectifyGOESDataSet()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to create the approximate transformer of the lat/lon lookup index.");
+		return CE_Failure;
+	}
+	GDALApproxTransformerOwnsSubtransformer(hTransformArg, TRUE);
+
+	//step 2: the warped VRT dataset on the rectified grid
+	int nBands = maptrDS->GetRasterCount();
+	GDALWarpOptions* psWO = GDALCreateWarpOptions();
+	psWO->hSrcDS = maptrDS.get();
+	psWO->eResampleAlg = GRA_NearestNeighbour;
+	psWO->pfnTransformer = GDALApproxTransform;
+	psWO->pTransformerArg = hTransformArg;
+	psWO->nBandCount = nBands;
+	psWO->panSrcBands = (int*) CPLMalloc(nBands * sizeof(int));
+	psWO->panDstBands = (int*) CPLMalloc(nBands * sizeof(int));
+	psWO->padfSrcNoDataReal = (double*) CPLMalloc(nBands * sizeof(double));
+	psWO->padfSrcNoDataImag = (double*) CPLMalloc(nBands * sizeof(double));
+	psWO->padfDstNoDataReal = (double*) CPLMalloc(nBands * sizeof(double));
+	psWO->padfDstNoDataImag = (double*) CPLMalloc(nBands * sizeof(double));
+	for (int i = 0; i < nBands; i++)
+	{
+		psWO->panSrcBands[i] = i + 1;
+		psWO->panDstBands[i] = i + 1;
+		psWO->padfSrcNoDataReal[i] = md_MissingValue;
+		psWO->padfSrcNoDataImag[i] = 0;
+		psWO->padfDstNoDataReal[i] = md_MissingValue;
+		psWO->padfDstNoDataImag[i] = 0;
+	}
+	psWO->papszWarpOptions = CSLSetNameValue(psWO->papszWarpOptions, "INIT_DEST", "NO_DATA");
 
-	if (CE_None != GDALReprojectImage(maptrDS.get(), NULL, rectDataSet,
-			pszDstWKT, GRA_NearestNeighbour, 0, 0.125, NULL, NULL, NULL))
+	GDALDataset* poWarpedDS = (GDALDataset*) GDALCreateWarpedVRT(maptrDS.get(),
+			mi_RectifiedImageXSize, mi_RectifiedImageYSize, md_Geotransform, psWO);
+	GDALDestroyWarpOptions(psWO);
+	if (NULL == poWarpedDS)
 	{
-		GDALClose(rectDataSet);
-		GDALClose(poDriver);
-		OGRFree(pszDstWKT);
-		SetWCS_ErrorLocator("AbstractDataset::RectifyDataSet()");
+		GDALDestroyApproxTransformer(hTransformArg);
+		SetWCS_ErrorLocator("NC_GOES_Dataset::RectifyGOESDataSet()");
 		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode,
 				"Failed to re-project GOES data from satellite GCP CRS to geographical CRS.");
-
 		return CE_Failure;
 	}
 
+	char *pszDstWKT;
+	mo_NativeCRS.exportToWkt(&pszDstWKT);
+	poWarpedDS->SetProjection(pszDstWKT);
 	OGRFree(pszDstWKT);
-	GDALClose(maptrDS.release());
+	for (int i = 1; i <= nBands; i++)
+		poWarpedDS->GetRasterBand(i)->SetNoDataValue(md_MissingValue);
 
-	maptrDS.reset(rectDataSet);
+	//The warped dataset holds its own reference to the source, and closes it
+	maptrDS.release()->Dereference();
+	maptrDS.reset(poWarpedDS);
 
 	return CE_None;
 }
-
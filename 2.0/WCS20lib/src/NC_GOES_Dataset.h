@@ -93,11 +93,30 @@ protected:
 
 	vector<GDAL_GCP>   		m_gdalGCPs;
 
+	// Lat/lon lookup index of the GOES fixed grid, see LoadLatLonIndex()
+	int				mi_IndexStepX;		// sampling of the latitude/longitude fields
+	int				mi_IndexStepY;
+	int				mi_IndexCols;		// nodes of the sampled grid
+	int				mi_IndexRows;
+	vector<float>	mv_IndexLonLat;		// longitude and latitude of each node, -999 off the earth
+	int				mi_BucketsX;		// grid of buckets over the bounding box
+	int				mi_BucketsY;
+	int				mb_BucketsWrap;		// the buckets span 360 degrees, the fixed grid crosses the antimeridian
+	double			md_BucketMinX;
+	double			md_BucketMinY;
+	double			md_BucketSize;
+	vector<GInt32>	mv_BucketWindow;	// min pixel, min line, max pixel and max line of each bucket, -1 if empty
+	vector<float>	mv_BucketCenter;	// mean pixel and line of each bucket
+
 public:
 	CPLErr SetGCPGeoRef4VRTDataset(GDALDataset* );
 	CPLErr SetGeoBBoxAndGCPs(GDALDataset* hSrcDS);
 	CPLErr RectifyGOESDataSet();
 	CPLErr setResampleStandard(GDALDataset* hSrcDS, int& xRSValue, int& yRSValue);
+	CPLErr LoadLatLonIndex(GDALRasterBand* poBandLat, GDALRasterBand* poBandLon);
+	CPLErr BuildLatLonIndex(GDALRasterBand* poBandLat, GDALRasterBand* poBandLon);
+	int GetLatLonOfPixel(double dfPixel, double dfLine, double& dfLon, double& dfLat);
+	int GetPixelOfLatLon(double dfLon, double dfLat, double& dfPixel, double& dfLine);
 
 	int isValidLatitude(const double &lat)
 	{
@@ -119,6 +119,9 @@ CPLErr NITF_Dataset::InitialDataset(const int isSimple)
 	////fetch data format
 	ms_NativeFormat = GDALGetDriverShortName(pSrc->GetDriver());
 
+	//the file holds only this image segment, so it could be delivered as is
+	mb_IsWholeFile = (CSLCount(pSrc->GetMetadata("SUBDATASETS")) == 0) ? TRUE : FALSE;
+
 	//set meta data list
 	SetMetaDataList(pSrc);
 
@@ -109,7 +109,7 @@ CPLErr TRMM_Dataset::InitialDataset(const int isSimple)
 
 	m_bDaily = EQUAL(ms_DatasetName.c_str(), "Daily") ? TRUE : FALSE;
 
-	GDALDataset* pSrc = (GDALDataset*) GDALOpen(ms_SrcFilename.c_str(), GA_ReadOnly);
+	GDALDataset* pSrc = (GDALDataset*) GDALOpenShared(ms_SrcFilename.c_str(), GA_ReadOnly);
 	if (pSrc == NULL)
 	{
 		SetWCS_ErrorLocator("TRMM_Dataset::initialDataset()");
@@ -162,7 +162,7 @@ CPLErr TRMM_Dataset::InitialDataset(const int isSimple)
 
 CPLErr TRMM_Dataset::SetNativeCRS()
 {
-	mo_NativeCRS.SetWellKnownGeogCS("WGS84");
+	ImportRegisteredCRS(mo_NativeCRS, "WGS84");
 	return CE_None;
 }
 
@@ -203,7 +203,10 @@ CPLErr TRMM_Dataset::SetGeoTransform()
  * \brief Set the GDALDataset object to TRMM dataset.
  *
  * This method is used to set the TRMM dataset based on GDAL
- * class VRTDataset.
+ * class VRTDataset. Only the bands selected in the band list (the days
+ * or 3-hourly slots resolved from the requested time subset) are added
+ * to the VRT dataset, so the other bands are never read from the
+ * HDF4 file. If the band list is empty, all bands are selected.
  *
  * @param isSimple the WCS request type.  When user executing a DescribeCoverage
  * request, isSimple is set to 1, and for GetCoverage, is set to 0.
@@ -215,57 +218,59 @@ CPLErr TRMM_Dataset::SetGDALDataset(const int isSimple)
 {
 	int nXSize = 1440;
 	int nYSize = 400;
-	int mBands = mv_BandList.size();
-	int sBands = maptrDS.get()->GetRasterCount();
-	int tBands = (mBands == 0) ? sBands : mBands;
-	if(mBands == 0)
+	int sBands = maptrDS->GetRasterCount();
+	if(mv_BandList.empty())
 	{
 		for(int i = 1; i <= sBands; i++)
 			mv_BandList.push_back(i);
 	}
 
-	GDALDataType eDT = maptrDS.get()->GetRasterBand(1)->GetRasterDataType();
+	for (unsigned int i = 0; i < mv_BandList.size(); i++)
+	{
+		if (mv_BandList[i] < 1 || mv_BandList[i] > sBands)
+		{
+			SetWCS_ErrorLocator("TRMM_Dataset::SetGDALDataset()");
+			WCS_Error(CE_Failure, OGC_WCS_InvalidSubsetting,
+					"The requested band/time slice %d is out of range (1 - %d).", mv_BandList[i], sBands);
+			return CE_Failure;
+		}
+	}
 
-	int bufSize = nXSize * nYSize * GDALGetDataTypeSize(eDT) / 8;
-	char *pData = (char *) CPLMalloc(bufSize);
+	VRTDataset *poVDS = (VRTDataset *)VRTCreate(nXSize, nYSize);
+	if (poVDS == NULL)
+	{
+		SetWCS_ErrorLocator("TRMM_Dataset::SetGDALDataset()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to create VRT DataSet.");
+		return CE_Failure;
+	}
 
 	char *psGeoSRS = NULL;
 	mo_NativeCRS.exportToWkt(&psGeoSRS);
+	poVDS->SetProjection(psGeoSRS);
+	poVDS->SetGeoTransform(md_Geotransform);
+	OGRFree(psGeoSRS);
 
-	GDALDriverH hDriver = GDALGetDriverByName("MEM");
-	GDALDataset* hSubDS = (GDALDataset*)GDALCreate( hDriver, "", nXSize, nYSize, tBands, eDT, NULL );
-	hSubDS->SetProjection(psGeoSRS);
-	hSubDS->SetGeoTransform(md_Geotransform);
-
-	if(!isSimple)
+	VRTSourcedRasterBand *poVRTBand = NULL;
+	GDALRasterBand *poSrcBand = NULL;
+	for (unsigned int i = 0; i < mv_BandList.size(); i++)
 	{
-		if(mBands == 0)
-		{
-			for(int i = 1; i <= sBands; i++)
-			{
-				int curBand = mv_BandList.at(i-1);
-				maptrDS.get()->GetRasterBand(curBand)->RasterIO(GF_Read, 0, 0, nXSize, nYSize, pData, nXSize, nYSize, eDT, 0, 0);
-				hSubDS->GetRasterBand(i)->SetNoDataValue(md_MissingValue);
-				hSubDS->GetRasterBand(i)->RasterIO(GF_Write, 0, 0, nXSize, nYSize, pData, nXSize, nYSize, eDT, 0, 0);
-			}
-		}
-		else
+		poSrcBand = maptrDS->GetRasterBand(mv_BandList[i]);
+		poVDS->AddBand(poSrcBand->GetRasterDataType(), NULL);
+		poVRTBand = (VRTSourcedRasterBand *) poVDS->GetRasterBand(i + 1);
+		poVRTBand->SetNoDataValue(md_MissingValue);
+
+		if (CE_None != poVRTBand->AddSimpleSource(poSrcBand, 0, 0, nXSize, nYSize,
+				0, 0, nXSize, nYSize, NULL, md_MissingValue))
 		{
-			for(int i = 1; i <= mBands; i++)
-			{
-				int curBand = mv_BandList.at(i-1);
-				maptrDS.get()->GetRasterBand(curBand)->RasterIO(GF_Read, 0, 0, nXSize, nYSize, pData, nXSize, nYSize, eDT, 0, 0);
-				hSubDS->GetRasterBand(i)->SetNoDataValue(md_MissingValue);
-				hSubDS->GetRasterBand(i)->RasterIO(GF_Write, 0, 0, nXSize, nYSize, pData, nXSize, nYSize, eDT, 0, 0);
-			}
+			GDALClose((GDALDatasetH) poVDS);
+			SetWCS_ErrorLocator("TRMM_Dataset::SetGDALDataset()");
+			WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to Add Simple Source into VRT DataSet.");
+			return CE_Failure;
 		}
 	}
 
-	VSIFree((char*) pData);
-	VSIFree((char*) psGeoSRS);
-
 	GDALClose(maptrDS.release());
-	maptrDS.reset(hSubDS);
+	maptrDS.reset(poVDS);
 
 	return CE_None;
 }
@@ -30,7 +30,14 @@
 
 #include <unistd.h>
 #include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 #include <stdexcept>
 #include <uuid/uuid.h>
 #include "wcsUtil.h"
@@ -568,8 +575,8 @@ CPLErr CPL_STDCALL GetTRMMBandList(string start, string end, std::vector<int> &b
 	int sdays = (int)(startsec - june1sec)/(24*3600) + 1;
 	int edays = (int)(endsec - june1sec)/(24*3600) + 1;
 
-	sdays = (sdays < 0) ? 0 : sdays;
-	edays = (edays < 0) ? sdays : edays;
+	sdays = (sdays < 1) ? 1 : sdays;
+	edays = (edays < sdays) ? sdays : edays;
 
 	for(int i = sdays; i <= edays; i++)
 		bandList.push_back(i);
@@ -577,6 +584,62 @@ CPLErr CPL_STDCALL GetTRMMBandList(string start, string end, std::vector<int> &b
 	return CE_None;
 }
 
+/************************************************************************/
+/*                       GetTRMM3HourlyBandList()                       */
+/************************************************************************/
+
+/**
+ * \brief Fetch the 3-hourly band list for TRMM data based on the range of date/time.
+ *
+ * The sub-daily TRMM products store one band for each 3-hour slot of the
+ * day, starting at 00:00Z (band 1 covers 00:00-03:00, band 8 covers
+ * 21:00-24:00). This method will find the slots which intersect with the
+ * specified date/time range, and store the band numbers to a array. The
+ * day of the start date/time is taken as the day of the granule.
+ *
+ * @param start The start date/time.
+ *
+ * @param end The end date/time, could be empty for a single time instant.
+ *
+ * @param bandList The array used to place the results.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr CPL_STDCALL GetTRMM3HourlyBandList(string start, string end, std::vector<int> &bandList)
+{
+	if(EQUAL(start.c_str(), "") && EQUAL(end.c_str(), ""))
+		return CE_None;
+
+	string dayStr = EQUAL(start.c_str(), "") ? end.substr(0, 10) : start.substr(0, 10);
+	long int daysec = ConvertDateTimeToSeconds(dayStr);
+	long int startsec = daysec, endsec = daysec + 24*3600 - 1;
+
+	if(!EQUAL(start.c_str(), ""))
+		startsec = ConvertDateTimeToSeconds(start);
+	if(!EQUAL(end.c_str(), ""))
+		endsec = ConvertDateTimeToSeconds(end);
+	else if(!EQUAL(start.c_str(), ""))
+		endsec = startsec;
+
+	int sslot = (int)((startsec - daysec) / (3*3600)) + 1;
+	int eslot = (int)((endsec - daysec) / (3*3600)) + 1;
+
+	sslot = (sslot < 1) ? 1 : sslot;
+	eslot = (eslot > 8) ? 8 : eslot;
+	if(sslot > eslot)
+	{
+		SetWCS_ErrorLocator("GetTRMM3HourlyBandList()");
+		WCS_Error(CE_Failure, OGC_WCS_InvalidSubsetting, "The time subset is out of the range of the TRMM granule.");
+		return CE_Failure;
+	}
+
+	for(int i = sslot; i <= eslot; i++)
+		bandList.push_back(i);
+
+	return CE_None;
+}
+
 
 /************************************************************************/
 /*                          GetTimeString()                             */
@@ -1366,5 +1429,501 @@ string CPL_STDCALL doPostFromFile(string requestURL, string postFilePath)
 	return doPostFromString(requestURL, postValue);
 }
 
+/************************************************************************/
+/*                          ParseHttpRanges()                           */
+/************************************************************************/
+
+/**
+ * \brief Parse the byte ranges of a HTTP Range header.
+ *
+ * This method will parse the value of HTTP Range header, such as
+ * "bytes=0-499", "bytes=500-", "bytes=-500" or "bytes=0-99,200-299",
+ * and clip each range to the size of the file. The ranges which are not
+ * satisfiable are dropped.
+ *
+ * @param rangeHeader The value of Range header (HTTP_RANGE in CGI environment).
+ *
+ * @param fileSize The size of the file to be delivered.
+ *
+ * @param starts The array used to place the first byte position of the ranges.
+ *
+ * @param ends The array used to place the last byte position of the ranges.
+ *
+ * @return The number of satisfiable ranges, 0 if none of the ranges is
+ * satisfiable, or -1 if there is no Range header or it could not be parsed,
+ * in which case the whole file should be delivered.
+ */
+
+int CPL_STDCALL ParseHttpRanges(const string& rangeHeader, GIntBig fileSize, vector<GIntBig>& starts, vector<GIntBig>& ends)
+{
+	starts.clear();
+	ends.clear();
+
+	string sRange = StrTrim(rangeHeader);
+	if (sRange.empty() || !EQUALN(sRange.c_str(), "bytes=", 6))
+		return -1;
+
+	vector<string> rangeSet;
+	CsvburstCpp(sRange.substr(6), rangeSet, ',');
+	for (unsigned int i = 0; i < rangeSet.size(); i++)
+	{
+		string sSpec = StrTrim(rangeSet[i]);
+		string::size_type idx = sSpec.find("-");
+		if (idx == string::npos)
+			return -1;
+
+		string sFirst = StrTrim(sSpec.substr(0, idx));
+		string sLast = StrTrim(sSpec.substr(idx + 1));
+		if (sFirst.find_first_not_of("0123456789") != string::npos ||
+			sLast.find_first_not_of("0123456789") != string::npos ||
+			(sFirst.empty() && sLast.empty()))
+			return -1;
+
+		GIntBig nStart, nEnd;
+		if (sFirst.empty())//suffix range, the last N bytes
+		{
+			GIntBig nSuffix = CPLScanUIntBig(sLast.c_str(), (int)sLast.size());
+			if (nSuffix == 0)
+				continue;
+			nStart = (nSuffix >= fileSize) ? 0 : fileSize - nSuffix;
+			nEnd = fileSize - 1;
+		}
+		else
+		{
+			nStart = CPLScanUIntBig(sFirst.c_str(), (int)sFirst.size());
+			nEnd = sLast.empty() ? fileSize - 1 : CPLScanUIntBig(sLast.c_str(), (int)sLast.size());
+			if (!sLast.empty() && nEnd < nStart)
+				return -1;
+			if (nEnd >= fileSize)
+				nEnd = fileSize - 1;
+		}
+
+		if (nStart >= fileSize)
+			continue;
+
+		starts.push_back(nStart);
+		ends.push_back(nEnd);
+	}
 
+	return (int)starts.size();
+}
+
+/************************************************************************/
+/*                           SendFileRange()                            */
+/************************************************************************/
 
+/**
+ * \brief Deliver a byte range of a file to the standard output.
+ *
+ * This method will copy the specified byte range of a file to the standard
+ * output (the CGI response) in the kernel, so the data does not pass
+ * through user space: splice() is used if the standard output is a pipe
+ * (the usual case under CGI), otherwise sendfile(). If neither is available
+ * for the standard output, read()/write() will be used instead.
+ *
+ * @param fd The file descriptor of the opened file.
+ *
+ * @param offset The first byte to be delivered.
+ *
+ * @param length The number of bytes to be delivered.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr CPL_STDCALL SendFileRange(int fd, GIntBig offset, GIntBig length)
+{
+	int bUseReadWrite = FALSE;
+
+#ifdef __linux__
+	struct stat sOutStat;
+	int bPipe = (fstat(STDOUT_FILENO, &sOutStat) == 0 && S_ISFIFO(sOutStat.st_mode)) ? TRUE : FALSE;
+
+	loff_t nOffset = (loff_t)offset;
+	while (length > 0)
+	{
+		size_t nChunk = (length > (1 << 30)) ? (1 << 30) : (size_t)length;
+		ssize_t nSent;
+		if (bPipe)
+			nSent = splice(fd, &nOffset, STDOUT_FILENO, NULL, nChunk, SPLICE_F_MORE);
+		else
+		{
+			off_t nFileOffset = (off_t)nOffset;
+			nSent = sendfile(STDOUT_FILENO, fd, &nFileOffset, nChunk);
+			if (nSent > 0)
+				nOffset = nFileOffset;
+		}
+
+		if (nSent < 0)
+		{
+			if (errno == EINTR || errno == EAGAIN)
+				continue;
+			if ((errno == EINVAL || errno == ENOSYS) && nOffset == (loff_t)offset)
+			{
+				bUseReadWrite = TRUE;
+				break;
+			}
+			return CE_Failure;
+		}
+		if (nSent == 0)
+			return CE_Failure;
+		length -= nSent;
+	}
+#else
+	bUseReadWrite = TRUE;
+#endif
+
+	if (!bUseReadWrite)
+		return CE_None;
+
+	if (lseek(fd, (off_t)offset, SEEK_SET) < 0)
+		return CE_Failure;
+
+	char buf[MAX_LINE_LEN];
+	while (length > 0)
+	{
+		ssize_t nRead = read(fd, buf, (length > MAX_LINE_LEN) ? MAX_LINE_LEN : (size_t)length);
+		if (nRead < 0 && errno == EINTR)
+			continue;
+		if (nRead <= 0)
+			return CE_Failure;
+
+		ssize_t nWritten = 0;
+		while (nWritten < nRead)
+		{
+			ssize_t n = write(STDOUT_FILENO, buf + nWritten, nRead - nWritten);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				return CE_Failure;
+			nWritten += n;
+		}
+		length -= nRead;
+	}
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                           HttpWriteBlocks()                          */
+/************************************************************************/
+
+/**
+ * \brief Write a list of blocks to the standard output.
+ *
+ * This method will write the blocks, such as the lines of HTTP headers,
+ * to the standard output with a single writev() call (repeated only when
+ * the write is partial). The pending content of cout is flushed first,
+ * so the order of the response is kept.
+ *
+ * @param blocks The blocks to be written.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr CPL_STDCALL HttpWriteBlocks(const vector<string>& blocks)
+{
+	cout.flush();
+
+	vector<struct iovec> iov;
+	for (unsigned int i = 0; i < blocks.size(); i++)
+	{
+		if (blocks[i].empty())
+			continue;
+		struct iovec v;
+		v.iov_base = (void*)blocks[i].data();
+		v.iov_len = blocks[i].size();
+		iov.push_back(v);
+	}
+
+	unsigned int iFirst = 0;
+	while (iFirst < iov.size())
+	{
+		int nCount = (int)MIN(iov.size() - iFirst, (size_t)IOV_MAX);
+		ssize_t nWritten = writev(STDOUT_FILENO, &iov[iFirst], nCount);
+		if (nWritten < 0 && errno == EINTR)
+			continue;
+		if (nWritten <= 0)
+			return CE_Failure;
+
+		while (iFirst < iov.size() && (size_t)nWritten >= iov[iFirst].iov_len)
+		{
+			nWritten -= iov[iFirst].iov_len;
+			iFirst++;
+		}
+		if (iFirst < iov.size() && nWritten > 0)
+		{
+			iov[iFirst].iov_base = (char*)iov[iFirst].iov_base + nWritten;
+			iov[iFirst].iov_len -= nWritten;
+		}
+	}
+
+	return CE_None;
+}
+
+/************************************************************************/
+/*                           GetFileByteSize()                          */
+/************************************************************************/
+
+/**
+ * \brief Fetch the size of a file.
+ *
+ * @param filePath The path of the file.
+ *
+ * @return The size of the file in bytes, or -1 on failure.
+ */
+
+GIntBig CPL_STDCALL GetFileByteSize(const string& filePath)
+{
+	struct stat sStat;
+	if (stat(filePath.c_str(), &sStat) != 0)
+		return -1;
+
+	return (GIntBig)sStat.st_size;
+}
+
+/************************************************************************/
+/*                          HttpWriteResponse()                         */
+/************************************************************************/
+
+/**
+ * \brief Deliver a response made of headers, a file range and a tail.
+ *
+ * This method will write the head blocks with HttpWriteBlocks(), transfer
+ * the byte range of the file with SendFileRange(), and then write the tail
+ * blocks, such as the following parts of a multipart response.
+ *
+ * @param head The blocks written before the file content.
+ *
+ * @param filePath The path of the file to be delivered.
+ *
+ * @param offset The first byte of the file to be delivered.
+ *
+ * @param length The number of bytes to be delivered, -1 for the rest of the file.
+ *
+ * @param tail The blocks written after the file content.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr CPL_STDCALL HttpWriteResponse(const vector<string>& head, const string& filePath, GIntBig offset, GIntBig length,
+		const vector<string>& tail)
+{
+	int fd = open(filePath.c_str(), O_RDONLY);
+	struct stat sStat;
+	if (fd < 0 || fstat(fd, &sStat) != 0)
+	{
+		if (fd >= 0)
+			close(fd);
+		SetWCS_ErrorLocator("HttpWriteResponse()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to open file \"%s\".", filePath.c_str());
+		return CE_Failure;
+	}
+
+	if (length < 0)
+		length = (GIntBig)sStat.st_size - offset;
+
+	CPLErr eErr = HttpWriteBlocks(head);
+	if (eErr == CE_None)
+		eErr = SendFileRange(fd, offset, length);
+	close(fd);
+
+	if (eErr == CE_None)
+		eErr = HttpWriteBlocks(tail);
+
+	return eErr;
+}
+
+/************************************************************************/
+/*                         GetFileContentHash()                         */
+/************************************************************************/
+
+/**
+ * \brief Fetch the hash of a file's content.
+ *
+ * This method will compute the 64-bit FNV-1a hash of the content of
+ * a file, which could be used as a strong entity tag (ETag) of the file.
+ *
+ * @param filePath The path of the file.
+ *
+ * @return The hash as a 16 digits hexadecimal string, or empty string on failure.
+ */
+
+string CPL_STDCALL GetFileContentHash(const string& filePath)
+{
+	int fd = open(filePath.c_str(), O_RDONLY);
+	if (fd < 0)
+		return "";
+
+	GUIntBig nHash = 14695981039346656037ULL;
+	unsigned char buf[MAX_LINE_LEN];
+	ssize_t nRead;
+	while ((nRead = read(fd, buf, MAX_LINE_LEN)) != 0)
+	{
+		if (nRead < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			close(fd);
+			return "";
+		}
+		for (ssize_t i = 0; i < nRead; i++)
+		{
+			nHash ^= buf[i];
+			nHash *= 1099511628211ULL;
+		}
+	}
+	close(fd);
+
+	char szHash[32];
+	snprintf(szHash, sizeof(szHash), "%016llx", (unsigned long long)nHash);
+
+	return szHash;
+}
+
+/************************************************************************/
+/*                            GetStringHash()                           */
+/************************************************************************/
+
+/**
+ * \brief Fetch the hash of a string.
+ *
+ * This method will compute the 64-bit FNV-1a hash of a string, the same
+ * hash as GetFileContentHash(), which could be used as a cache key.
+ *
+ * @param value The string to be hashed.
+ *
+ * @return The hash as a 16 digits hexadecimal string.
+ */
+
+string CPL_STDCALL GetStringHash(const string& value)
+{
+	GUIntBig nHash = 14695981039346656037ULL;
+	for (string::size_type i = 0; i < value.size(); i++)
+	{
+		nHash ^= (unsigned char)value[i];
+		nHash *= 1099511628211ULL;
+	}
+
+	char szHash[32];
+	snprintf(szHash, sizeof(szHash), "%016llx", (unsigned long long)nHash);
+
+	return szHash;
+}
+
+/************************************************************************/
+/*                            HttpSendFile()                            */
+/************************************************************************/
+
+/**
+ * \brief Deliver a file to user with HTTP Range support.
+ *
+ * This method will deliver a file to user as the CGI response. If a single
+ * satisfiable byte range is requested, a "206 Partial Content" response with
+ * the range is delivered; if several ranges are requested, a "206 Partial
+ * Content" response of "multipart/byteranges" is delivered; if none of the
+ * ranges is satisfiable, a "416 Requested Range Not Satisfiable" response is
+ * delivered; otherwise the whole file is delivered.
+ *
+ * If an entity tag is given, it is delivered as the ETag header, and the
+ * ranges are only honored when the If-Range value matches it, so a resumed
+ * download never mixes two versions of a file.
+ *
+ * @param filePath The path of the file to be delivered.
+ *
+ * @param contentType The content type header lines of the response, such as
+ * "Content-Type: image/tiff".
+ *
+ * @param rangeHeader The value of Range header, could be empty.
+ *
+ * @param eTag The strong entity tag of the file (with quotes), could be empty.
+ *
+ * @param ifRange The value of If-Range header, could be empty.
+ *
+ * @return CE_None on success or CE_Failure on failure.
+ */
+
+CPLErr CPL_STDCALL HttpSendFile(const string& filePath, const string& contentType, const string& rangeHeader,
+		const string& eTag, const string& ifRange)
+{
+	GIntBig fileSize = GetFileByteSize(filePath);
+	if (fileSize < 0)
+	{
+		SetWCS_ErrorLocator("HttpSendFile()");
+		WCS_Error(CE_Failure, OGC_WCS_NoApplicableCode, "Failed to open file \"%s\".", filePath.c_str());
+		return CE_Failure;
+	}
+
+	vector<GIntBig> starts, ends;
+	int nRanges = -1;
+	if (ifRange.empty() || (!eTag.empty() && StrTrim(ifRange) == eTag))
+		nRanges = ParseHttpRanges(rangeHeader, fileSize, starts, ends);
+
+	vector<string> head, tail;
+	if (!eTag.empty())
+		head.push_back("ETag: " + eTag + "\r\n");
+
+	if (nRanges == 0)
+	{
+		head.push_back("Status: 416 Requested Range Not Satisfiable\r\n");
+		head.push_back("Content-Range: bytes */" + convertToString(fileSize) + "\r\n");
+		head.push_back("Content-Length: 0\r\n\r\n");
+		return HttpWriteBlocks(head);
+	}
+
+	head.push_back("Accept-Ranges: bytes\r\n");
+
+	if (nRanges > 1)
+	{
+		string sBoundary = "gmueowcs_byteranges";
+		string sPartType = contentType.substr(0, contentType.find("\r\n"));
+		vector<string> partHeads;
+		GIntBig length = 0;
+		for (int i = 0; i < nRanges; i++)
+		{
+			string sPartHead = "\r\n--" + sBoundary + "\r\n" + sPartType + "\r\n" +
+					"Content-Range: bytes " + convertToString(starts[i]) + "-" + convertToString(ends[i]) +
+					"/" + convertToString(fileSize) + "\r\n\r\n";
+			partHeads.push_back(sPartHead);
+			length += sPartHead.size() + (ends[i] - starts[i] + 1);
+		}
+		string sClose = "\r\n--" + sBoundary + "--\r\n";
+		length += sClose.size();
+
+		head.push_back("Status: 206 Partial Content\r\n");
+		head.push_back("Content-Length: " + convertToString(length) + "\r\n");
+		head.push_back("Content-Type: multipart/byteranges; boundary=" + sBoundary + "\r\n\r\n");
+
+		int fd = open(filePath.c_str(), O_RDONLY);
+		if (fd < 0)
+			return CE_Failure;
+
+		CPLErr eErr = HttpWriteBlocks(head);
+		for (int i = 0; i < nRanges && eErr == CE_None; i++)
+		{
+			vector<string> part(1, partHeads[i]);
+			eErr = HttpWriteBlocks(part);
+			if (eErr == CE_None)
+				eErr = SendFileRange(fd, starts[i], ends[i] - starts[i] + 1);
+		}
+		close(fd);
+
+		if (eErr == CE_None)
+			tail.push_back(sClose);
+		return (eErr == CE_None) ? HttpWriteBlocks(tail) : eErr;
+	}
+
+	GIntBig offset = 0, length = fileSize;
+	if (nRanges == 1)
+	{
+		offset = starts[0];
+		length = ends[0] - starts[0] + 1;
+		head.push_back("Status: 206 Partial Content\r\n");
+		head.push_back("Content-Range: bytes " + convertToString(starts[0]) + "-" + convertToString(ends[0]) +
+				"/" + convertToString(fileSize) + "\r\n");
+	}
+
+	head.push_back("Content-Length: " + convertToString(length) + "\r\n");
+	head.push_back(contentType + "\r\n\r\n");
+
+	return HttpWriteResponse(head, filePath, offset, length, tail);
+}
@@ -376,6 +376,7 @@ string CPL_DLL CPL_STDCALL		GetSubSetLatLon(const string& subsetstr, vector<doub
 string CPL_DLL CPL_STDCALL 		GetSingleValue(const string& subsetstr);
 
 CPLErr CPL_DLL CPL_STDCALL 		GetTRMMBandList(string start, string end, std::vector<int> &bandList);
+CPLErr CPL_DLL CPL_STDCALL 		GetTRMM3HourlyBandList(string start, string end, std::vector<int> &bandList);
 void CPL_DLL CPL_STDCALL 		GetCornerPoints(const GDAL_GCP* &pGCPList, const int &nGCPs, My2DPoint& lowLeft, My2DPoint& upRight);
 
 bool CPL_DLL CPL_STDCALL		saveURLtoFile(string requestURL, string filePath);
@@ -383,6 +384,18 @@ string CPL_DLL CPL_STDCALL		doGetFromString(string requestURL);
 string CPL_DLL CPL_STDCALL		doPostFromString(string requestURL, string postValue);
 string CPL_DLL CPL_STDCALL		doPostFromFile(string requestURL, string postFilePath);
 
+// HTTP Response Related
+int CPL_DLL CPL_STDCALL			ParseHttpRanges(const string& rangeHeader, GIntBig fileSize, vector<GIntBig>& starts, vector<GIntBig>& ends);
+CPLErr CPL_DLL CPL_STDCALL		SendFileRange(int fd, GIntBig offset, GIntBig length);
+CPLErr CPL_DLL CPL_STDCALL		HttpWriteBlocks(const vector<string>& blocks);
+GIntBig CPL_DLL CPL_STDCALL		GetFileByteSize(const string& filePath);
+CPLErr CPL_DLL CPL_STDCALL		HttpWriteResponse(const vector<string>& head, const string& filePath, GIntBig offset, GIntBig length,
+		const vector<string>& tail);
+string CPL_DLL CPL_STDCALL		GetFileContentHash(const string& filePath);
+string CPL_DLL CPL_STDCALL		GetStringHash(const string& value);
+CPLErr CPL_DLL CPL_STDCALL		HttpSendFile(const string& filePath, const string& contentType, const string& rangeHeader,
+		const string& eTag = "", const string& ifRange = "");
+
 
 CPL_C_END
 